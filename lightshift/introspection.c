@@ -1,7 +1,7 @@
 // Hook into lightshift tapping terms
 #ifndef LIGHTSHIFT_USER_TAPPING_TERM
     uint16_t get_tapping_term(uint16_t keycode, keyrecord_t *record) {
-        if (is_lightshift(keycode)) {
+        if (is_lightshift_mod(keycode)) {
             return get_lightshift_term(keycode, record);
         }
         return TAPPING_TERM;
@@ -11,7 +11,7 @@
 // Disable PERMISSIVE_HOLD for lightshift keys
 #if defined(PERMISSIVE_HOLD) && !defined(LIGHTSHIFT_USER_PERMISSIVE_HOLD)
     bool get_permissive_hold(uint16_t keycode, keyrecord_t *record) {
-        if (is_lightshift(keycode)) {
+        if (is_lightshift_mod(keycode)) {
             return false;
         }
         return true;
@@ -24,7 +24,7 @@
                       keyrecord_t* tap_hold_record,
                       uint16_t other_keycode,
                       keyrecord_t* other_record) {
-        if (is_lightshift(tap_hold_keycode)) return false;
+        if (is_lightshift_mod(tap_hold_keycode)) return false;
         return true;
     }
 #endif
@@ -33,10 +33,20 @@
 #if defined(FLOW_TAP_TERM) && !defined(LIGHTSHIFT_USER_FLOW_TAP)
     uint16_t get_flow_tap_term(uint16_t keycode, keyrecord_t* record,
                                uint16_t prev_keycode) {
-        if (is_lightshift(keycode)) return 0;
+        if (is_lightshift_mod(keycode)) return 0;
         if (is_flow_tap_key(keycode) && is_flow_tap_key(prev_keycode)) {    
             return FLOW_TAP_TERM;
         }
         return 0;
     }
 #endif
+
+// Handle term profile commands over raw HID
+#if defined(LIGHTSHIFT_PROFILES) && defined(RAW_ENABLE) \
+    && !defined(VIA_ENABLE) && !defined(LIGHTSHIFT_USER_RAW_HID)
+    #include "lightshift_profiles.h"
+
+    void raw_hid_receive(uint8_t *data, uint8_t length) {
+        lightshift_raw_hid_receive(data, length);
+    }
+#endif
@@ -3,6 +3,14 @@
 #include "lightshift_tracking.h"
 #include "lightshift_state.h"
 #include "lightshift_drop.h"
+#include "lightshift_adaptive.h"
+#include "lightshift_tuning.h"
+#include "lightshift_bigram.h"
+#include "lightshift_profiles.h"
+#include "lightshift_stats.h"
+#include "lightshift_mods.h"
+#include "lightshift_streak.h"
+#include "lightshift_termcost.h"
 
 ASSERT_COMMUNITY_MODULES_MIN_API_VERSION(1, 0, 0);
 
@@ -25,19 +33,47 @@ ASSERT_COMMUNITY_MODULES_MIN_API_VERSION(1, 0, 0);
 //
 ///////////////////////////////////////////////////////////////////////////////
 
+// Adds a shift's contextual (bigram) adjustment to its tapping term
+static uint16_t adjust_term(uint16_t term, const keyrecord_t *record) {
+    // a term which never expires stays that way
+    if (!lghts_bigrams() || term == UINT16_MAX) return term;
+
+    int32_t adjusted = (int32_t)term
+                       + lghts_get_term_adjust(record->event.key);
+    if (adjusted < 1) return 1;
+    if (adjusted >= UINT16_MAX) return UINT16_MAX - 1;
+    return (uint16_t)adjusted;
+}
+
+
 // Returns the current tapping term for lightshift keys
 uint16_t calculate_term(uint16_t keycode, const keyrecord_t *record) {
-    
-    // extended tapping term
-    if (lghts_use_extended_tt(record->event.key)) {
-        return LIGHTSHIFT_EXTENDED_TAPPING_TERM;
-    }
-
-    // low regular tapping term
-    if (is_lightshift(keycode)) return LIGHTSHIFT_TAPPING_TERM;
+    // extended tapping term, or low regular tapping term?
+    bool extended = lghts_use_extended_tt(record->event.key);
+    lightshift_class_t mod_class = lghts_mod_class(keycode);
 
     // failsafe
-    return TAPPING_TERM;
+    if (!extended && mod_class == LGHTS_CLASS_NONE) return TAPPING_TERM;
+
+    // a key's own profile takes precedence over the global term
+    uint16_t term = lghts_profiles()
+                    ? lghts_profile_term(record->event.key, extended) : 0;
+
+    // other home-row mods: their class's term
+    if (!term && mod_class != LGHTS_CLASS_SHIFT
+              && mod_class != LGHTS_CLASS_NONE) {
+        return lghts_class_term(mod_class, extended);
+    }
+
+    // shifts: adaptive or (self-tuned) global term
+    if (!term && extended) {
+        term = lghts_adaptive() ? lghts_adaptive_extended_term()
+                                : lghts_tuned_extended_term();
+    }
+    else if (!term) {
+        term = lghts_adaptive() ? lghts_adaptive_term() : lghts_tuned_term();
+    }
+    return adjust_term(term, record);
 }
 
 
@@ -54,7 +90,8 @@ uint16_t calculate_term(uint16_t keycode, const keyrecord_t *record) {
 static void clear_any_double_shift(uint16_t keycode,
                                    const keyrecord_t* record) {
     // leave shifts active if:
-    if (!record->event.pressed // event is a release, not a press
+    if (!lghts_slots_in_state(SHIFT_DOUBLE_SHIFTING) // no double shifts
+            || !record->event.pressed // event is a release, not a press
             || lghts_is_layer_or_mod(keycode, record) // layer switch / mod key
             || lightshift_allow_double(keycode, record) // double shift allowed
             || lghts_non_shift_mods_active()) { // other mods active (shortcut)
@@ -65,26 +102,102 @@ static void clear_any_double_shift(uint16_t keycode,
     uint16_t shift_keycode = lghts_set_double_inactive(keycode);
     if (shift_keycode != KC_NO) {
         lghts_clear_modtap_mods(shift_keycode);
+        if (lghts_stats()) lghts_stats_dropshift_clear();
     }
 }
 
 
+///////////////////////////////////////////////////////////////////////////////
+//
+// Disabled Layers (e.g. gaming, numpad)
+//
+///////////////////////////////////////////////////////////////////////////////
+
+static layer_state_t disabled_layers = LIGHTSHIFT_DISABLED_LAYERS;
+
+void lightshift_set_disabled_layers(layer_state_t layers) {
+    disabled_layers = layers;
+}
+
+layer_state_t lightshift_get_disabled_layers(void) {
+    return disabled_layers;
+}
+
+// Stand aside? Only while a disabled layer is on, and once no shift is left
+// tracked (so a shift pressed before the layer switch is seen to release)
+static inline bool standing_aside(void) {
+    return ((layer_state | default_layer_state) & disabled_layers)
+           && !lghts_active_slots();
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////
 //
 // QMK Hooks
 //
 ///////////////////////////////////////////////////////////////////////////////
 
+// Called once at startup
+void keyboard_post_init_lightshift(void) {
+    // resolve handedness once, rather than on every keypress
+    lghts_init_handedness();
+    // load self-tuned tapping terms
+    lghts_tuning_init();
+    // load per-key term profiles
+    lghts_profiles_init();
+    // load saved decision counts
+    if (lghts_stats()) lghts_stats_init();
+    // count cycles, to measure tapping term calls
+    if (lghts_term_costs()) lghts_term_costs_init();
+}
+
+// Called continuously
+void housekeeping_task_lightshift(void) {
+    // save self-tuned tapping terms once they settle
+    lghts_tuning_task();
+    // save decision counts every so often
+    if (lghts_stats()) lghts_stats_task();
+    // count tapping term calls per scan
+    if (lghts_term_costs()) lghts_term_costs_task();
+}
+
 // Called on _physical_ keypresses
 bool pre_process_record_lightshift(uint16_t keycode, keyrecord_t *record) {
-    // track lightshift state
-    lghts_track_ppr(keycode, record);
+    // count tapping term calls per key press (on any layer)
+    if (lghts_term_costs()) lghts_term_costs_event(record);
+
+    // nothing to do on disabled layers
+    if (standing_aside()) return true;
+
+    // follow typing rhythm for adaptive tapping terms
+    lghts_adaptive_update(record);
+    // follow typing streaks, in which lightshifts are tapped at once
+    if (lghts_streak()) lghts_streak_update(keycode, record);
+
+    // track lightshift state (nothing to do unless a shift is pressed or
+    // being pressed)
+    if (lghts_active_slots() || is_lightshift_mod(keycode)) {
+        lghts_track_ppr(keycode, record);
+    }
+    // remember letters typed, for bigram-aware tapping terms
+    if (lghts_bigrams()) lghts_bigram_note_press(keycode, record);
     return true;
 }
 
 // Called after QMK decides TAP or HOLD
 bool process_record_lightshift(uint16_t keycode, keyrecord_t* record) {
-    if (lghts_dropshift()) {
+    // nothing to do on disabled layers
+    if (standing_aside()) return true;
+
+    // print tapping term costs, then decision counts, on LS_STAT
+    if (lghts_term_costs()) lghts_term_costs_process(keycode, record);
+    if (!lghts_stats_process(keycode, record)) return false;
+
+    // watch for misshift corrections, to self-tune tapping terms
+    lghts_tuning_process(keycode, record);
+
+    if (lghts_dropshift()
+            && (lghts_active_slots() || is_lightshift_mod(keycode))) {
         // if this key may not be double shifted, clear any double shift
         clear_any_double_shift(keycode, record);
         // track lightshift state
@@ -93,12 +206,26 @@ bool process_record_lightshift(uint16_t keycode, keyrecord_t* record) {
     return true;
 }
 
-// Called continuously while there are unresolved TAP / HOLD decisions
-// Hooked via get_tapping_term() in introspection.c
-uint16_t get_lightshift_term(uint16_t keycode, const keyrecord_t *record) {
+// Returns the tapping term for a lightshift key press
+static uint16_t lightshift_term(uint16_t keycode, const keyrecord_t *record) {
+    // plain mod-taps on disabled layers
+    if (standing_aside()) return TAPPING_TERM;
+
     // return contextual tapping term for lightshift keys
     const uint16_t term = calculate_term(keycode, record);
     // debug print (noisy!)
     // lghts_dprintf("%s: TT=%u", get_keycode_string(keycode), term);
     return term;
 }
+
+// Called continuously while there are unresolved TAP / HOLD decisions
+// Hooked via get_tapping_term() in introspection.c
+uint16_t get_lightshift_term(uint16_t keycode, const keyrecord_t *record) {
+    if (!lghts_term_costs()) return lightshift_term(keycode, record);
+
+    // measured: count the call and its cycles
+    uint32_t start = lightshift_read_cycles();
+    uint16_t term = lightshift_term(keycode, record);
+    lghts_term_costs_call(lightshift_read_cycles() - start);
+    return term;
+}
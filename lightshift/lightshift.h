@@ -22,6 +22,19 @@
     #error "LIGHTSHIFT_EXTENDED_TAPPING_TERM must be no more than 65,535ms"
 #endif
 
+// # of simult. MT shift presses tracked; any more will be normal MTs
+#ifndef LIGHTSHIFT_MAX_TRACKED
+	#define LIGHTSHIFT_MAX_TRACKED 2
+#endif
+#if LIGHTSHIFT_MAX_TRACKED < 1
+    #error "LIGHTSHIFT_MAX_TRACKED must be at least 1"
+#endif
+
+// layers on which Lightshift stands aside, as a bitmask (bit n => layer n)
+#ifndef LIGHTSHIFT_DISABLED_LAYERS
+	#define LIGHTSHIFT_DISABLED_LAYERS 0
+#endif
+
 /**
  * @brief Convenience method for access to DROPSHIFT_ENABLE parameter
  */
@@ -33,6 +46,40 @@ inline bool lghts_dropshift(void) {
     #endif
 }
 
+/**
+ * @brief Resolves handedness for every matrix position, for fast lookups
+ * 
+ * Called at keyboard init.  Call again only if handedness changes at runtime.
+ */
+void lghts_init_handedness(void);
+
+/**
+ * @brief Returns the handedness of a key, as resolved at keyboard init
+ * 
+ * Cheap to call; use it in preference to lightshift_handedness() on hot
+ * paths.
+ * 
+ * @return 'L', 'R' or '*'
+ */
+char lightshift_cached_handedness(keypos_t key);
+
+/**
+ * @brief Sets the layers on which Lightshift stands aside, e.g. gaming layers
+ * 
+ * While any of these layers is on (or is the default layer), lightshifts are
+ * plain mod-taps: no tracking, contextual terms or Dropshift.  Shifts pressed
+ * before a switch to one of these layers are tracked until released.
+ * 
+ * @param layers bitmask of layers (bit n => layer n), replacing
+ *        LIGHTSHIFT_DISABLED_LAYERS
+ */
+void lightshift_set_disabled_layers(layer_state_t layers);
+
+/**
+ * @brief Returns the layers on which Lightshift stands aside
+ */
+layer_state_t lightshift_get_disabled_layers(void);
+
 /**
  * @brief Returns the correct tapping term for a lightshift key press
  */
@@ -0,0 +1,126 @@
+#include "lightshift.h"
+#include "lightshift_adaptive.h"
+#include "lightshift_tuning.h"
+#include "lightshift_debug.h"
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// State
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// averages are kept in 1/16ths of a ms, for precision with integer maths
+// (0 = no samples yet)
+static uint16_t interval_x16 = 0; // between key presses
+static uint16_t hold_x16 = 0;     // from press to release
+
+// last key press, for measuring intervals & holds
+static keypos_t last_press_key;
+static uint16_t last_press_time = 0;
+static bool last_press_held = false; // is the last pressed key still down?
+
+// terms derived from the averages (recomputed on each key event, so
+// get_lightshift_term() just reads them)
+static uint16_t cached_term = LIGHTSHIFT_TAPPING_TERM;
+static uint16_t cached_extended_term = LIGHTSHIFT_EXTENDED_TAPPING_TERM;
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Averages
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Fold a sample into an exponentially weighted average: avg += (x - avg) / 8
+static uint16_t add_sample(uint16_t avg_x16, uint16_t sample) {
+    int32_t sample_x16 = (int32_t)sample * 16;
+    if (avg_x16 == 0) return (uint16_t)sample_x16; // first sample
+    return (uint16_t)(avg_x16 + (sample_x16 - (int32_t)avg_x16) / 8);
+}
+
+
+// Scale term by average interval / reference interval
+static uint32_t scale(uint16_t term) {
+    return ((uint32_t)term * interval_x16)
+           / (LIGHTSHIFT_ADAPTIVE_REFERENCE_INTERVAL * 16);
+}
+
+
+// Recompute the terms from the averages
+static void update_terms(void) {
+    if (interval_x16 == 0) return;
+
+    // lightshift term: scaled, but above the average hold, and within bounds
+    uint32_t term = scale(lghts_tuned_term());
+    uint32_t hold_floor = (hold_x16 >> 4) + LIGHTSHIFT_ADAPTIVE_HOLD_MARGIN;
+    if (term < hold_floor) term = hold_floor;
+    if (term < LIGHTSHIFT_ADAPTIVE_MIN_TERM) {
+        term = LIGHTSHIFT_ADAPTIVE_MIN_TERM;
+    }
+    if (term > LIGHTSHIFT_ADAPTIVE_MAX_TERM) {
+        term = LIGHTSHIFT_ADAPTIVE_MAX_TERM;
+    }
+
+    // extended term: scaled, if custom (65,535ms means never expire)
+    uint32_t extended = lghts_tuned_extended_term();
+    if (extended != UINT16_MAX) {
+        extended = scale(extended);
+        if (extended < term) extended = term;
+        if (extended >= UINT16_MAX) extended = UINT16_MAX - 1;
+    }
+
+    if (term != cached_term) {
+        lghts_dprintf("Adaptive TT: %u (interval %u, hold %u)",
+                      (uint16_t)term, interval_x16 >> 4, hold_x16 >> 4);
+    }
+    cached_term = (uint16_t)term;
+    cached_extended_term = (uint16_t)extended;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Interface
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Update averages from a key event: intervals from successive presses, and
+// holds from the most recently pressed key (a cheap, representative sample
+// which needs no per-key storage)
+void lghts_adaptive_update(const keyrecord_t *record) {
+    if (!lghts_adaptive()) return;
+
+    uint16_t time = record->event.time;
+
+    if (record->event.pressed) {
+        uint16_t interval = time - last_press_time;
+        if (interval <= LIGHTSHIFT_ADAPTIVE_MAX_INTERVAL) {
+            interval_x16 = add_sample(interval_x16, interval);
+        }
+        last_press_key = record->event.key;
+        last_press_time = time;
+        last_press_held = true;
+    }
+    else if (last_press_held && KEYEQ(record->event.key, last_press_key)) {
+        uint16_t hold = time - last_press_time;
+        if (hold <= LIGHTSHIFT_ADAPTIVE_MAX_INTERVAL) {
+            hold_x16 = add_sample(hold_x16, hold);
+        }
+        last_press_held = false;
+    }
+    else {
+        return; // nothing changed
+    }
+
+    update_terms();
+}
+
+
+uint16_t lghts_adaptive_term(void) {
+    return interval_x16 ? cached_term : lghts_tuned_term();
+}
+
+
+uint16_t lghts_adaptive_extended_term(void) {
+    return interval_x16 ? cached_extended_term : lghts_tuned_extended_term();
+}
@@ -0,0 +1,92 @@
+/**
+ * lightshift_adaptive.h
+ * 
+ * Adaptive tapping terms follow your typing rhythm: fast typing gets shorter
+ * terms (fewer missed opposite-side shifts), slow typing gets longer ones.
+ * 
+ * Lightshift keeps exponentially weighted averages of the interval between
+ * key presses and of key hold durations.  The lightshift tapping term is
+ * (after any self-tuning, see lightshift_tuning.h) scaled by the ratio of
+ * the average interval to a reference interval, is
+ * kept above the average hold duration (so ordinary taps aren't mistaken for
+ * holds), and is clamped to configurable bounds.  A custom (not 65,535ms)
+ * extended tapping term is scaled by the same ratio.
+ * 
+ * Enable with LIGHTSHIFT_ADAPTIVE in config.h.
+ * 
+ */
+
+#pragma once
+#include "quantum.h"
+
+#ifndef LIGHTSHIFT_ADAPTIVE_MIN_TERM
+    #define LIGHTSHIFT_ADAPTIVE_MIN_TERM 100
+#endif
+
+#ifndef LIGHTSHIFT_ADAPTIVE_MAX_TERM
+    #define LIGHTSHIFT_ADAPTIVE_MAX_TERM 250
+#endif
+
+// interval between key presses at which the configured terms apply unscaled
+#ifndef LIGHTSHIFT_ADAPTIVE_REFERENCE_INTERVAL
+    #define LIGHTSHIFT_ADAPTIVE_REFERENCE_INTERVAL 150
+#endif
+
+// how far the lightshift tapping term is kept above the average hold
+#ifndef LIGHTSHIFT_ADAPTIVE_HOLD_MARGIN
+    #define LIGHTSHIFT_ADAPTIVE_HOLD_MARGIN 30
+#endif
+
+// longer intervals are pauses, not typing rhythm, so are ignored
+#ifndef LIGHTSHIFT_ADAPTIVE_MAX_INTERVAL
+    #define LIGHTSHIFT_ADAPTIVE_MAX_INTERVAL 1000
+#endif
+
+#if LIGHTSHIFT_ADAPTIVE_MIN_TERM > LIGHTSHIFT_ADAPTIVE_MAX_TERM
+    #error "LIGHTSHIFT_ADAPTIVE_MIN_TERM must not exceed ..._MAX_TERM"
+#endif
+#if LIGHTSHIFT_ADAPTIVE_MAX_INTERVAL > 4000
+    #error "LIGHTSHIFT_ADAPTIVE_MAX_INTERVAL must be no more than 4,000ms"
+#endif
+#if LIGHTSHIFT_ADAPTIVE_REFERENCE_INTERVAL == 0
+    #error "LIGHTSHIFT_ADAPTIVE_REFERENCE_INTERVAL must be more than 0ms"
+#endif
+
+/**
+ * @brief Convenience method for access to LIGHTSHIFT_ADAPTIVE parameter
+ */
+inline bool lghts_adaptive(void) {
+    #ifdef LIGHTSHIFT_ADAPTIVE
+        return true;
+    #else
+        return false;
+    #endif
+}
+
+
+/**
+ * @brief Updates the typing rhythm averages, and the terms derived from them
+ * 
+ * Call from pre_process_record on every key event.  O(1).
+ * 
+ * @param record Record for the key event
+ */
+void lghts_adaptive_update(const keyrecord_t *record);
+
+
+/**
+ * @brief Current (adapted) lightshift tapping term
+ * 
+ * @return adapted term, or the (tuned) lightshift term until typing has
+ *         been seen
+ */
+uint16_t lghts_adaptive_term(void);
+
+
+/**
+ * @brief Current (adapted) extended tapping term
+ * 
+ * @return adapted term, or the (tuned) extended term if that is left at
+ *         its default (65,535ms, i.e. never expires)
+ */
+uint16_t lghts_adaptive_extended_term(void);
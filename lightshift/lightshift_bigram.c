@@ -0,0 +1,73 @@
+#include "lightshift_bigram.h"
+#include "lightshift_tracking.h"
+#include "lightshift_debug.h"
+
+#ifdef LIGHTSHIFT_BIGRAMS
+
+// generated at build time by tools/gen_bigram_terms.py (see rules.mk)
+#include "lightshift_bigrams.h"
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// State
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#define NOT_A_LETTER 26 // last row of lightshift_bigram_adjust[][][]
+
+// letters (0-25, or NOT_A_LETTER) of the last two key presses
+// (latest first; layer & mod keys are skipped, as they don't decide terms)
+static uint8_t recent_letters[2] = {NOT_A_LETTER, NOT_A_LETTER};
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Interface
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Letter index of a key press (MT / LT keys aren't yet resolved in
+// pre_process_record, so use their tap keycodes)
+static uint8_t letter_of(uint16_t keycode) {
+    if (IS_QK_MOD_TAP(keycode)) keycode = QK_MOD_TAP_GET_TAP_KEYCODE(keycode);
+    if (IS_QK_LAYER_TAP(keycode)) {
+        keycode = QK_LAYER_TAP_GET_TAP_KEYCODE(keycode);
+    }
+    if (keycode < KC_A || keycode > KC_Z) return NOT_A_LETTER;
+    return keycode - KC_A;
+}
+
+
+void lghts_bigram_note_press(uint16_t keycode, const keyrecord_t *record) {
+    if (!record->event.pressed || is_layer_or_mod_ppr(keycode)) return;
+    recent_letters[1] = recent_letters[0];
+    recent_letters[0] = letter_of(keycode);
+}
+
+
+// The deciding key hasn't been noted yet, so recent_letters[0] is the shift
+// key's own letter, and recent_letters[1] the letter before it
+int8_t lghts_bigram_adjust(uint16_t shift_keycode, bool same_hand) {
+    uint16_t tap_keycode = QK_MOD_TAP_GET_TAP_KEYCODE(shift_keycode);
+    for (uint8_t s = 0; s < LIGHTSHIFT_BIGRAM_SHIFTS; s++) {
+        lghts_probe_iteration();
+        if (lightshift_bigram_shift_keycodes[s] == tap_keycode) {
+            // another key between previous letter & shift: no context
+            uint8_t prev = recent_letters[0] == letter_of(tap_keycode)
+                           ? recent_letters[1] : NOT_A_LETTER;
+            return (int8_t)pgm_read_byte(
+                &lightshift_bigram_adjust[prev][s][same_hand ? 0 : 1]);
+        }
+    }
+    return 0;
+}
+
+#else
+
+void lghts_bigram_note_press(uint16_t keycode, const keyrecord_t *record) {}
+
+int8_t lghts_bigram_adjust(uint16_t shift_keycode, bool same_hand) {
+    return 0;
+}
+
+#endif
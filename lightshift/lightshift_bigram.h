@@ -0,0 +1,53 @@
+/**
+ * lightshift_bigram.h
+ * 
+ * Bigram-aware tapping terms adjust the lightshift and extended tapping
+ * terms for the context of each shift press: the letter typed before the
+ * shift key, which shift key it is, and whether the next key is on the same
+ * side or the opposite side.  Fast same-hand rolls like "st" can then get a
+ * longer term than rare ones.
+ * 
+ * The adjustments are a small table in flash, generated at build time by
+ * tools/gen_bigram_terms.py from a text corpus or a CSV file (see rules.mk).
+ * They are looked up once, when the shift's term is decided, and stored
+ * with the shift, so get_lightshift_term() needs no table lookup.
+ * 
+ */
+
+#pragma once
+#include "quantum.h"
+
+/**
+ * @brief Convenience method for access to LIGHTSHIFT_BIGRAMS parameter
+ */
+inline bool lghts_bigrams(void) {
+    #ifdef LIGHTSHIFT_BIGRAMS
+        return true;
+    #else
+        return false;
+    #endif
+}
+
+
+/**
+ * @brief Records the letter (if any) typed by a key press
+ * 
+ * Call from pre_process_record on every key event, after tracking.  O(1).
+ * 
+ * @param keycode Keycode assigned to the key event by QMK
+ * @param record Record for the key event
+ */
+void lghts_bigram_note_press(uint16_t keycode, const keyrecord_t *record);
+
+
+/**
+ * @brief Tapping term adjustment for a shift whose term is being decided
+ * 
+ * Call while deciding the term, before the deciding key is noted.
+ * 
+ * @param shift_keycode keycode of the shift key
+ * @param same_hand true if the deciding key is on the same side as the shift
+ * 
+ * @return adjustment in ms (0 if the context is not in the table)
+ */
+int8_t lghts_bigram_adjust(uint16_t shift_keycode, bool same_hand);
@@ -28,3 +28,18 @@ static inline bool lghts_debug(void) {
     do {                                                            \
         if (lghts_debug()) xprintf(fmt "\n", ##__VA_ARGS__);   \
     } while (0)
+
+
+/**
+ * @brief Count a loop iteration, only if LIGHTSHIFT_COST_PROBE defined
+ * 
+ * Every loop on the keypress path counts its iterations here, so the
+ * simulator's explorer can find the most work any one hook call does.  On
+ * the keyboard, it compiles to nothing.
+ */
+#ifdef LIGHTSHIFT_COST_PROBE
+    extern uint32_t lghts_probe_iterations;
+    #define lghts_probe_iteration() (lghts_probe_iterations++)
+#else
+    #define lghts_probe_iteration() ((void)0)
+#endif
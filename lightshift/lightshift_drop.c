@@ -1,5 +1,6 @@
 #include "lightshift_drop.h"
 #include "lightshift_debug.h"
+#include "lightshift_keyclass.h"
 
 ///////////////////////////////////////////////////////////////////////////////
 //
@@ -7,20 +8,18 @@
 //
 ///////////////////////////////////////////////////////////////////////////////
 
-// Is this keypress a letter (A-Z)?
-bool is_letter(uint16_t keycode, const keyrecord_t *record) {
-
-    // convert tapped MT / LT keys to tap keycode
+// Returns the keycode typed by this keypress: the tap keycode of a tapped
+// MT / LT key, otherwise the keycode itself
+static uint16_t typed_keycode(uint16_t keycode, const keyrecord_t *record) {
     if (record->tap.count == 1) {
         if (IS_QK_MOD_TAP(keycode)) {
-            keycode = QK_MOD_TAP_GET_TAP_KEYCODE(keycode);
+            return QK_MOD_TAP_GET_TAP_KEYCODE(keycode);
         }
         if (IS_QK_LAYER_TAP(keycode)) {
-            keycode = QK_LAYER_TAP_GET_TAP_KEYCODE(keycode);
+            return QK_LAYER_TAP_GET_TAP_KEYCODE(keycode);
         }
     }
-
-    return keycode >= KC_A && keycode <= KC_Z;
+    return keycode;
 }
 
 
@@ -31,18 +30,20 @@ bool is_letter(uint16_t keycode, const keyrecord_t *record) {
 ///////////////////////////////////////////////////////////////////////////////
 
 // Returns true if this keycode, once shifted, should prevent further keycodes
-// from being shifted afterwards
+// from being shifted afterwards (letters, unless configured otherwise)
 bool lightshift_consume_single_raw(uint16_t keycode,
                                    const keyrecord_t *record) {
-    return is_letter(keycode, record);
+    return lghts_key_is(typed_keycode(keycode, record),
+                        LGHTS_KEY_CONSUMES_SINGLE);
 }
 
 
 // Returns true if this keycode may be shifted even after another keycode
-// has been shifted already
+// has been shifted already (all but letters, unless configured otherwise)
 bool lightshift_allow_double_raw(uint16_t keycode,
                                  const keyrecord_t *record) {
-    return !is_letter(keycode, record);
+    keycode = typed_keycode(keycode, record);
+    return keycode > 0xFF || lghts_key_is(keycode, LGHTS_KEY_ALLOWS_DOUBLE);
 }
 
 
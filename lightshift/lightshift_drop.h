@@ -14,7 +14,8 @@
  * doubles are ignored.)
  * 
  * You can change which keys consume the single, and which keys clear the shift
- * on a double, by overriding lightshift_consume_single() and / or
+ * on a double, with keycode lists in config.h (see lightshift_keyclass.h), or
+ * by overriding lightshift_consume_single() and / or
  * lightshift_allow_double() in keymap.c.
  * 
  */
@@ -25,7 +26,9 @@
 /**
  * @brief Checks if the given key should consume the single shift
  * 
- * By default, singles are only consumed by letters (A-Z).
+ * By default, singles are only consumed by letters (A-Z); add or remove
+ * basic keycodes with LIGHTSHIFT_CONSUME_SINGLE and LIGHTSHIFT_KEEP_SINGLE
+ * in config.h.
  * 
  * Even if a shift is consumed by this function, subsequent letters will still
  * be shifted if they are designated as double-allowed in
@@ -60,6 +63,8 @@ bool lightshift_consume_single(uint16_t keycode, const keyrecord_t *record);
  * By default, this function drops shift only on letter (A-Z) doubles,
  * to avoid inadvertent double capitalization, while allowing punctuation
  * and other keys to be shifted multiple times with a single shift hold.
+ * Add or remove basic keycodes with LIGHTSHIFT_DROP_DOUBLE and
+ * LIGHTSHIFT_ALLOW_DOUBLE in config.h.
  * 
  * You may override this function in your keymap.c for custom behaviour.
  * (See example below.)
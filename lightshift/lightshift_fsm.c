@@ -0,0 +1,179 @@
+#include "lightshift_fsm.h"
+#include "lightshift_debug.h"
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// State Machine
+//
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+*     
+*                                  ┌─────────────────┐
+*                                  │     INACTIVE    │
+*                                  └────────┬────────┘
+*                                           │
+*                                      [pp] shift
+*                                        pressed
+*                                           │
+*                                           v      
+*                                  ┌─────────────────┐
+*          ┌───────────────────────│    UNRESOLVED   │─────────────────┐
+*          │                       └────────┬────────┘                 │
+*          │                                │                          │
+*          │                    ┌───────────┴───────────┐              │
+*          │                    │                       │              │
+*       tapping          [pp] opp-side           [pp] same-side    [pp] shift
+*        term                  key                     key          released
+*          │                    │                       │            (=tap)
+*          │                    v                       v              │
+*          │         ┌─────────────────────┐    ┌───────────────┐      │
+*          │         │    LIGHTSHIFT TT    │    │  EXTENDED TT  │      │
+*          │         └───┬─────────────┬───┘    └───────┬───────┘      │
+*          │             │             │                │              │
+*          │          tapping     [pp] shift       [pp] shift          │
+*          │           term        released         released           │
+*          │             │          (=tap)           (=tap)            │
+*          │             │             │                │              │
+*          │             │             │                │              │
+*          v             v             │                v              │
+*    ┌────────────────────────────┐    │        ┌───────────────┐      │
+*    │      SINGLE SHIFTING       │    │        │   RELEASED,   │      │
+*    └─────┬─────────────┬────────┘    │        │   EXTENDED    │      │
+*          │             │             │        └───────┬───────┘      │
+*      consuming         └─── shift ───┐                │              │
+*      shiftable             released  │                │              │
+*      keypress                        │                │              │
+*          │                           │                │              │
+*          v                           │                │              │
+*    ┌────────────────────────────┐    │                │              │
+*    │      DOUBLE SHIFTING       │    │                │              │
+*    └──────┬────────────┬────────┘    │                │              │
+*           │            │             │                │              │
+*      disallowed        └─── shift ───┐          [pp] any next        │
+*       shiftable            released  │            key event          │
+*       keypress                       │                │              │
+*           │                          │                │              │
+*           v                          v                v              v
+*    ┌─────────────────────────────────────────────────────────────────────┐
+*    │                            INACTIVE                                 │
+*    └─────────────────────────────────────────────────────────────────────┘
+*
+*    Transition Triggers:
+*    --------------------
+*    [pp]   => pre_process_record  (for Extended Tapping Term)
+*    others => process_record      (for Dropshift)
+*
+* 
+*    NB: EXTENDED_TT -> SINGLE_SHIFTING is also possible, should the
+*        Extended Tapping Term expire. The default ETT of 65,535ms renders
+*        this impossible in real-world use, but shorter, custom ETTs may
+*        allow for it.
+* 
+*    Typing streaks (LIGHTSHIFT_STREAK): a lightshift pressed mid-streak is
+*    a tap from the start, so skips the tap-hold decision altogether:
+* 
+*        INACTIVE --[pp] shift pressed in streak--> STREAK TAP
+*        STREAK TAP --[pp] shift released--> INACTIVE
+* 
+*/
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Transition Table
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Each entry packs the action (high nibble) and next state (low nibble) into
+// one byte, so the whole table is 80 bytes of flash.  Unlisted entries are 0,
+// i.e. LGHTS_ACT_NONE: the event doesn't affect shifts in that state.
+#define T(next, action)  ((uint8_t)(((action) << 4) | (next)))
+#define MOVE(next)       T(next, LGHTS_ACT_MOVE)
+#define DECIDE(next)     T(next, LGHTS_ACT_TERM_DECIDED)
+#define EXPIRE(next)     T(next, LGHTS_ACT_EXTENDED_EXPIRED)
+
+_Static_assert(LIGHTSHIFT_STATE_COUNT <= 16 && LIGHTSHIFT_ACTION_COUNT <= 16,
+               "transitions must fit in a nibble each");
+_Static_assert(LGHTS_ACT_NONE == 0, "unlisted transitions must be no-ops");
+
+static const uint8_t transitions[LIGHTSHIFT_STATE_COUNT]
+                                [LIGHTSHIFT_EVENT_COUNT] PROGMEM = {
+    [SHIFT_INACTIVE] = {
+        [LGHTS_EV_SHIFT_PRESSED]  = MOVE(SHIFT_UNRESOLVED),
+        [LGHTS_EV_STREAK_PRESSED] = MOVE(SHIFT_STREAK_TAP),
+    },
+    [SHIFT_UNRESOLVED] = {
+        [LGHTS_EV_OPP_SIDE_KEY]   = DECIDE(SHIFT_LIGHTSHIFT_TT),
+        [LGHTS_EV_SAME_SIDE_KEY]  = DECIDE(SHIFT_EXTENDED_TT),
+        [LGHTS_EV_TAP_RELEASED]   = MOVE(SHIFT_INACTIVE),
+        [LGHTS_EV_TERM_EXPIRED]   = MOVE(SHIFT_SINGLE_SHIFTING),
+    },
+    [SHIFT_LIGHTSHIFT_TT] = {
+        [LGHTS_EV_TAP_RELEASED]   = MOVE(SHIFT_INACTIVE),
+        [LGHTS_EV_TERM_EXPIRED]   = MOVE(SHIFT_SINGLE_SHIFTING),
+    },
+    [SHIFT_EXTENDED_TT] = {
+        // keep the Extended TT after release, as QMK doesn't decide
+        // mod-taps until later in the processing cycle
+        [LGHTS_EV_TAP_RELEASED]   = MOVE(SHIFT_RELEASED_EXTENDED),
+        // short, custom Extended TTs can expire
+        [LGHTS_EV_TERM_EXPIRED]   = EXPIRE(SHIFT_SINGLE_SHIFTING),
+    },
+    [SHIFT_RELEASED_EXTENDED] = {
+        [LGHTS_EV_NEXT_KEY]       = MOVE(SHIFT_INACTIVE),
+    },
+    [SHIFT_SINGLE_SHIFTING] = {
+        [LGHTS_EV_CONSUMED]       = MOVE(SHIFT_DOUBLE_SHIFTING),
+        [LGHTS_EV_HOLD_RELEASED]  = MOVE(SHIFT_INACTIVE),
+    },
+    [SHIFT_DOUBLE_SHIFTING] = {
+        [LGHTS_EV_DISALLOWED]     = MOVE(SHIFT_INACTIVE),
+        [LGHTS_EV_HOLD_RELEASED]  = MOVE(SHIFT_INACTIVE),
+    },
+    [SHIFT_STREAK_TAP] = {
+        [LGHTS_EV_TAP_RELEASED]   = MOVE(SHIFT_INACTIVE),
+    },
+};
+
+#undef T
+#undef MOVE
+#undef DECIDE
+#undef EXPIRE
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Dispatch
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Looks up a transition
+lightshift_action_t lghts_fsm_lookup(lightshift_state_t state,
+                                     lightshift_event_t event,
+                                     lightshift_state_t *next) {
+    if (state >= LIGHTSHIFT_STATE_COUNT || event >= LIGHTSHIFT_EVENT_COUNT) {
+        return LGHTS_ACT_NONE;
+    }
+    uint8_t entry = pgm_read_byte(&transitions[state][event]);
+    lightshift_action_t action = entry >> 4;
+    if (action != LGHTS_ACT_NONE) *next = entry & 0x0F;
+    return action;
+}
+
+
+// Fires an event at the lightshift in a slot
+lightshift_action_t lghts_fire_slot(uint8_t slot, lightshift_event_t event) {
+    lightshift_state_t state = lghts_slot_state(slot);
+    if (state == SHIFT_INACTIVE) return LGHTS_ACT_NONE; // slot not in use
+    lightshift_state_t next;
+    lightshift_action_t action = lghts_fsm_lookup(state, event, &next);
+    if (action != LGHTS_ACT_NONE) lghts_set_slot_state(slot, next);
+    return action;
+}
+
+
+// Fires an event at one tracked lightshift
+lightshift_action_t lghts_fire(keypos_t key, lightshift_event_t event) {
+    return lghts_fire_slot(lghts_find_slot(key), event);
+}
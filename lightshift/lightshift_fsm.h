@@ -0,0 +1,79 @@
+/**
+ * lightshift_fsm.h
+ * 
+ * The lightshift state machine, as a single constant transition table:
+ * (state x event) -> (next state, action).
+ * 
+ * Tracking code classifies each key event, then fires it at the shifts it
+ * concerns; the table alone decides what happens next.
+ */
+
+#pragma once
+#include "quantum.h"
+#include "lightshift_state.h"
+
+// Events, as seen by a tracked lightshift
+typedef enum {
+    LGHTS_EV_SHIFT_PRESSED,    // [pp] the lightshift itself was pressed
+    LGHTS_EV_STREAK_PRESSED,   // [pp] ...pressed in a typing streak
+    LGHTS_EV_OPP_SIDE_KEY,     // [pp] an opposite-side key was pressed
+    LGHTS_EV_SAME_SIDE_KEY,    // [pp] a same-side key was pressed
+    LGHTS_EV_TAP_RELEASED,     // [pp] the lightshift was released (as a tap)
+    LGHTS_EV_NEXT_KEY,         // [pp] any key event after a tap release
+    LGHTS_EV_TERM_EXPIRED,     // tapping term expired (i.e. held)
+    LGHTS_EV_CONSUMED,         // a shiftable keypress used the shift
+    LGHTS_EV_DISALLOWED,       // a disallowed double shift was dropped
+    LGHTS_EV_HOLD_RELEASED,    // the lightshift was released (as a hold)
+    LIGHTSHIFT_EVENT_COUNT,
+} lightshift_event_t;
+
+// Actions, for the caller to carry out after a transition
+typedef enum {
+    LGHTS_ACT_NONE,            // no transition
+    LGHTS_ACT_MOVE,            // state changed; nothing else to do
+    LGHTS_ACT_TERM_DECIDED,    // a tapping term was chosen (same / opp side)
+    LGHTS_ACT_EXTENDED_EXPIRED,// an extended tapping term expired
+    LIGHTSHIFT_ACTION_COUNT,
+} lightshift_action_t;
+
+
+/**
+ * @brief Looks up a transition; no side effects
+ * 
+ * @param state current state
+ * @param event event seen by the shift in that state
+ * @param next set to the next state (unchanged if there's no transition)
+ * 
+ * @return action; LGHTS_ACT_NONE if the event has no effect in this state
+ */
+lightshift_action_t lghts_fsm_lookup(lightshift_state_t state,
+                                     lightshift_event_t event,
+                                     lightshift_state_t *next);
+
+
+/**
+ * @brief Fires an event at a tracked lightshift, moving it to its next state
+ * 
+ * LGHTS_EV_SHIFT_PRESSED and LGHTS_EV_STREAK_PRESSED are handled by
+ * lghts_start_tracking(), as an untracked shift has no state to move.
+ * 
+ * @param key Key position of the tracked lightshift
+ * @param event event seen by the shift
+ * 
+ * @return action for the caller to carry out (LGHTS_ACT_NONE if the event
+ *         had no effect, or the key isn't tracked)
+ */
+lightshift_action_t lghts_fire(keypos_t key, lightshift_event_t event);
+
+
+/**
+ * @brief Fires an event at the lightshift in a slot
+ * 
+ * As lghts_fire(), for callers already visiting shifts by slot.
+ * 
+ * @param slot slot of the shift (LGHTS_NO_SLOT / unused slots are ignored)
+ * @param event event seen by the shift
+ * 
+ * @return action for the caller to carry out
+ */
+lightshift_action_t lghts_fire_slot(uint8_t slot, lightshift_event_t event);
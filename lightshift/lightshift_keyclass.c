@@ -0,0 +1,40 @@
+#include "lightshift_keyclass.h"
+
+// each user list's bits of byte n (none if the list isn't defined)
+#ifdef LIGHTSHIFT_CONSUME_SINGLE
+    #define CONSUME_SINGLE(n) LGHTS_LIST_BITS(n, LIGHTSHIFT_CONSUME_SINGLE)
+#else
+    #define CONSUME_SINGLE(n) 0
+#endif
+#ifdef LIGHTSHIFT_KEEP_SINGLE
+    #define KEEP_SINGLE(n) LGHTS_LIST_BITS(n, LIGHTSHIFT_KEEP_SINGLE)
+#else
+    #define KEEP_SINGLE(n) 0
+#endif
+#ifdef LIGHTSHIFT_DROP_DOUBLE
+    #define DROP_DOUBLE(n) LGHTS_LIST_BITS(n, LIGHTSHIFT_DROP_DOUBLE)
+#else
+    #define DROP_DOUBLE(n) 0
+#endif
+#ifdef LIGHTSHIFT_ALLOW_DOUBLE
+    #define ALLOW_DOUBLE(n) LGHTS_LIST_BITS(n, LIGHTSHIFT_ALLOW_DOUBLE)
+#else
+    #define ALLOW_DOUBLE(n) 0
+#endif
+
+#define LETTERS(n) LGHTS_RANGE_BITS(n, KC_A, KC_Z)
+#define MODIFIERS(n) LGHTS_RANGE_BITS(n, KC_LEFT_CTRL, KC_RIGHT_GUI)
+
+// letters consume the single, plus any listed, minus any kept
+#define CONSUMES_SINGLE(n) \
+    ((uint8_t)((LETTERS(n) | CONSUME_SINGLE(n)) & ~KEEP_SINGLE(n)))
+// anything but a letter may be a double, plus any allowed, minus any dropped
+#define ALLOWS_DOUBLE(n) \
+    ((uint8_t)((~LETTERS(n) | ALLOW_DOUBLE(n)) & ~DROP_DOUBLE(n)))
+
+const uint8_t lghts_key_classes[LGHTS_KEY_CLASS_COUNT]
+                               [LGHTS_KEY_CLASS_BYTES] PROGMEM = {
+    [LGHTS_KEY_CONSUMES_SINGLE] = LGHTS_BITMAP(CONSUMES_SINGLE),
+    [LGHTS_KEY_ALLOWS_DOUBLE]   = LGHTS_BITMAP(ALLOWS_DOUBLE),
+    [LGHTS_KEY_LAYER_OR_MOD]    = LGHTS_BITMAP(MODIFIERS),
+};
@@ -0,0 +1,98 @@
+/**
+ * lightshift_keyclass.h
+ *
+ * Classifies basic keycodes for Dropshift and state tracking, from constant
+ * bitmaps built at compile time: one bit per basic keycode (0x00-0xFF) per
+ * class, so a lookup is a single bit test.
+ *
+ * By default, letters (A-Z) consume the single shift and drop shift on a
+ * double, and modifiers (KC_LEFT_CTRL to KC_RIGHT_GUI) are layer / mod keys.
+ * Change the defaults with lists of up to 16 keycodes in config.h, e.g.
+ *
+ *     #define LIGHTSHIFT_CONSUME_SINGLE KC_2          // @Jess -> @jess
+ *     #define LIGHTSHIFT_DROP_DOUBLE KC_QUOTE, KC_2   // I"ve -> I've
+ *
+ * Lists: LIGHTSHIFT_CONSUME_SINGLE, LIGHTSHIFT_KEEP_SINGLE,
+ *        LIGHTSHIFT_DROP_DOUBLE, LIGHTSHIFT_ALLOW_DOUBLE
+ *
+ */
+
+#pragma once
+#include "quantum.h"
+
+typedef enum {
+    LGHTS_KEY_CONSUMES_SINGLE,   // consumes a single shift
+    LGHTS_KEY_ALLOWS_DOUBLE,     // may be shifted as a double
+    LGHTS_KEY_LAYER_OR_MOD,      // layer / mod key, ignored by tracking
+    LGHTS_KEY_CLASS_COUNT,
+} lghts_key_class_t;
+
+// one bit per basic keycode: 32 bytes (of PROGMEM) per class
+#define LGHTS_KEY_CLASS_BYTES 32
+extern const uint8_t lghts_key_classes[LGHTS_KEY_CLASS_COUNT]
+                                      [LGHTS_KEY_CLASS_BYTES] PROGMEM;
+
+/**
+ * @brief Is a basic keycode in a class?
+ *
+ * @param keycode Keycode to be checked (non-basic keycodes are in no class)
+ * @param key_class Class of interest
+ *
+ * @return true if the keycode's bit is set in the class's bitmap
+ */
+static inline bool lghts_key_is(uint16_t keycode,
+                                lghts_key_class_t key_class) {
+    if (keycode > 0xFF) return false;
+    return pgm_read_byte(&lghts_key_classes[key_class][keycode >> 3])
+           & (1 << (keycode & 7));
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Bitmap Construction (for lightshift_keyclass.c)
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// bits of byte n of a bitmap, for a keycode range or a list of keycodes
+#define LGHTS_RANGE_BITS(n, first, last) \
+    ((uint8_t)(((n) * 8 + 7 < (first) || (n) * 8 > (last)) ? 0 \
+        : ((0xFF << ((first) > (n) * 8 ? (first) - (n) * 8 : 0)) \
+           & (0xFF >> ((last) < (n) * 8 + 7 ? (n) * 8 + 7 - (last) : 0)))))
+#define LGHTS_LIST_BITS(n, ...) \
+    ((uint8_t)(0 LGHTS_CAT(LGHTS_EACH_, LGHTS_COUNT(__VA_ARGS__)) \
+                   (n, __VA_ARGS__)))
+
+#define LGHTS_BIT(n, kc) | ((((kc) >> 3) == (n)) ? 1 << ((kc) & 7) : 0)
+#define LGHTS_EACH_1(n, kc) LGHTS_BIT(n, kc)
+#define LGHTS_EACH_2(n, kc, ...) LGHTS_BIT(n, kc) LGHTS_EACH_1(n, __VA_ARGS__)
+#define LGHTS_EACH_3(n, kc, ...) LGHTS_BIT(n, kc) LGHTS_EACH_2(n, __VA_ARGS__)
+#define LGHTS_EACH_4(n, kc, ...) LGHTS_BIT(n, kc) LGHTS_EACH_3(n, __VA_ARGS__)
+#define LGHTS_EACH_5(n, kc, ...) LGHTS_BIT(n, kc) LGHTS_EACH_4(n, __VA_ARGS__)
+#define LGHTS_EACH_6(n, kc, ...) LGHTS_BIT(n, kc) LGHTS_EACH_5(n, __VA_ARGS__)
+#define LGHTS_EACH_7(n, kc, ...) LGHTS_BIT(n, kc) LGHTS_EACH_6(n, __VA_ARGS__)
+#define LGHTS_EACH_8(n, kc, ...) LGHTS_BIT(n, kc) LGHTS_EACH_7(n, __VA_ARGS__)
+#define LGHTS_EACH_9(n, kc, ...) LGHTS_BIT(n, kc) LGHTS_EACH_8(n, __VA_ARGS__)
+#define LGHTS_EACH_10(n, kc, ...) LGHTS_BIT(n, kc) LGHTS_EACH_9(n, __VA_ARGS__)
+#define LGHTS_EACH_11(n, kc, ...) LGHTS_BIT(n, kc) LGHTS_EACH_10(n, __VA_ARGS__)
+#define LGHTS_EACH_12(n, kc, ...) LGHTS_BIT(n, kc) LGHTS_EACH_11(n, __VA_ARGS__)
+#define LGHTS_EACH_13(n, kc, ...) LGHTS_BIT(n, kc) LGHTS_EACH_12(n, __VA_ARGS__)
+#define LGHTS_EACH_14(n, kc, ...) LGHTS_BIT(n, kc) LGHTS_EACH_13(n, __VA_ARGS__)
+#define LGHTS_EACH_15(n, kc, ...) LGHTS_BIT(n, kc) LGHTS_EACH_14(n, __VA_ARGS__)
+#define LGHTS_EACH_16(n, kc, ...) LGHTS_BIT(n, kc) LGHTS_EACH_15(n, __VA_ARGS__)
+
+#define LGHTS_COUNT(...) LGHTS_COUNT_(__VA_ARGS__, 16, 15, 14, 13, 12, 11, \
+                                      10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define LGHTS_COUNT_(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, \
+                     _13, _14, _15, _16, count, ...) count
+#define LGHTS_CAT(a, b) LGHTS_CAT_(a, b)
+#define LGHTS_CAT_(a, b) a##b
+
+// a bitmap's 32 bytes, each from BYTE(n)
+#define LGHTS_BITMAP(BYTE) { \
+    BYTE(0),  BYTE(1),  BYTE(2),  BYTE(3),  BYTE(4),  BYTE(5),  BYTE(6),  \
+    BYTE(7),  BYTE(8),  BYTE(9),  BYTE(10), BYTE(11), BYTE(12), BYTE(13), \
+    BYTE(14), BYTE(15), BYTE(16), BYTE(17), BYTE(18), BYTE(19), BYTE(20), \
+    BYTE(21), BYTE(22), BYTE(23), BYTE(24), BYTE(25), BYTE(26), BYTE(27), \
+    BYTE(28), BYTE(29), BYTE(30), BYTE(31), \
+}
@@ -0,0 +1,30 @@
+#include "lightshift_mods.h"
+
+// Returns the class of a mod-tap key, by its 5-bit mods (left & right alike)
+lightshift_class_t lghts_mod_class(uint16_t keycode) {
+    if (!IS_QK_MOD_TAP(keycode)) return LGHTS_CLASS_NONE;
+    uint8_t mods = QK_MOD_TAP_GET_MODS(keycode);
+    if (mods & MOD_LSFT) return LGHTS_CLASS_SHIFT;
+    if (LGHTS_CTRL_SLOTS && (mods & MOD_LCTL)) return LGHTS_CLASS_CTRL;
+    if (LGHTS_ALT_SLOTS && (mods & MOD_LALT)) return LGHTS_CLASS_ALT;
+    if (LGHTS_GUI_SLOTS && (mods & MOD_LGUI)) return LGHTS_CLASS_GUI;
+    return LGHTS_CLASS_NONE;
+}
+
+
+// Returns a class's configured term
+uint16_t lghts_class_term(lightshift_class_t mod_class, bool extended) {
+    switch (mod_class) {
+        case LGHTS_CLASS_CTRL:
+            return extended ? LIGHTSHIFT_CTRL_EXTENDED_TAPPING_TERM
+                            : LIGHTSHIFT_CTRL_TAPPING_TERM;
+        case LGHTS_CLASS_ALT:
+            return extended ? LIGHTSHIFT_ALT_EXTENDED_TAPPING_TERM
+                            : LIGHTSHIFT_ALT_TAPPING_TERM;
+        case LGHTS_CLASS_GUI:
+            return extended ? LIGHTSHIFT_GUI_EXTENDED_TAPPING_TERM
+                            : LIGHTSHIFT_GUI_TAPPING_TERM;
+        default:
+            return TAPPING_TERM;
+    }
+}
@@ -0,0 +1,124 @@
+/**
+ * lightshift_mods.h
+ * 
+ * Contextual tapping terms for other home-row mods: Ctrl, Alt and GUI
+ * mod-taps can be tracked just like shifts, resolving to a low term before
+ * an opposite-side key, or an extended term before a same-side key.  Each
+ * class of mod has its own terms and tracking capacity.
+ * 
+ * Dropshift, adaptive, self-tuned and bigram-aware terms remain for shifts
+ * only; per-key term profiles apply to every tracked key.
+ * 
+ * Enable each class with LIGHTSHIFT_CTRL, LIGHTSHIFT_ALT or LIGHTSHIFT_GUI
+ * in config.h.
+ * 
+ */
+
+#pragma once
+#include "quantum.h"
+#include "lightshift.h"
+
+// Classes of mod-tap key; a mod-tap with several mods belongs to the first
+// enabled class among them, in this order
+typedef enum {
+    LGHTS_CLASS_SHIFT,
+    LGHTS_CLASS_CTRL,
+    LGHTS_CLASS_ALT,
+    LGHTS_CLASS_GUI,
+    LIGHTSHIFT_CLASS_COUNT,
+    LGHTS_CLASS_NONE = LIGHTSHIFT_CLASS_COUNT, // not tracked
+} lightshift_class_t;
+
+#ifndef LIGHTSHIFT_CTRL_TAPPING_TERM
+    #define LIGHTSHIFT_CTRL_TAPPING_TERM LIGHTSHIFT_TAPPING_TERM
+#endif
+#ifndef LIGHTSHIFT_CTRL_EXTENDED_TAPPING_TERM
+    #define LIGHTSHIFT_CTRL_EXTENDED_TAPPING_TERM \
+        LIGHTSHIFT_EXTENDED_TAPPING_TERM
+#endif
+#ifndef LIGHTSHIFT_ALT_TAPPING_TERM
+    #define LIGHTSHIFT_ALT_TAPPING_TERM LIGHTSHIFT_TAPPING_TERM
+#endif
+#ifndef LIGHTSHIFT_ALT_EXTENDED_TAPPING_TERM
+    #define LIGHTSHIFT_ALT_EXTENDED_TAPPING_TERM \
+        LIGHTSHIFT_EXTENDED_TAPPING_TERM
+#endif
+#ifndef LIGHTSHIFT_GUI_TAPPING_TERM
+    #define LIGHTSHIFT_GUI_TAPPING_TERM LIGHTSHIFT_TAPPING_TERM
+#endif
+#ifndef LIGHTSHIFT_GUI_EXTENDED_TAPPING_TERM
+    #define LIGHTSHIFT_GUI_EXTENDED_TAPPING_TERM \
+        LIGHTSHIFT_EXTENDED_TAPPING_TERM
+#endif
+#if LIGHTSHIFT_CTRL_TAPPING_TERM > UINT16_MAX \
+    || LIGHTSHIFT_CTRL_EXTENDED_TAPPING_TERM > UINT16_MAX \
+    || LIGHTSHIFT_ALT_TAPPING_TERM > UINT16_MAX \
+    || LIGHTSHIFT_ALT_EXTENDED_TAPPING_TERM > UINT16_MAX \
+    || LIGHTSHIFT_GUI_TAPPING_TERM > UINT16_MAX \
+    || LIGHTSHIFT_GUI_EXTENDED_TAPPING_TERM > UINT16_MAX
+    #error "Lightshift Ctrl / Alt / GUI terms must be no more than 65,535ms"
+#endif
+
+// # of simult. presses tracked per class; any more will be normal MTs
+#ifndef LIGHTSHIFT_CTRL_MAX_TRACKED
+    #define LIGHTSHIFT_CTRL_MAX_TRACKED 2
+#endif
+#ifndef LIGHTSHIFT_ALT_MAX_TRACKED
+    #define LIGHTSHIFT_ALT_MAX_TRACKED 2
+#endif
+#ifndef LIGHTSHIFT_GUI_MAX_TRACKED
+    #define LIGHTSHIFT_GUI_MAX_TRACKED 2
+#endif
+
+// tracking slots reserved per class (none unless the class is enabled)
+#ifdef LIGHTSHIFT_CTRL
+    #define LGHTS_CTRL_SLOTS LIGHTSHIFT_CTRL_MAX_TRACKED
+#else
+    #define LGHTS_CTRL_SLOTS 0
+#endif
+#ifdef LIGHTSHIFT_ALT
+    #define LGHTS_ALT_SLOTS LIGHTSHIFT_ALT_MAX_TRACKED
+#else
+    #define LGHTS_ALT_SLOTS 0
+#endif
+#ifdef LIGHTSHIFT_GUI
+    #define LGHTS_GUI_SLOTS LIGHTSHIFT_GUI_MAX_TRACKED
+#else
+    #define LGHTS_GUI_SLOTS 0
+#endif
+
+/**
+ * @brief Are any mods other than shift tracked?
+ * 
+ * @return true if any of LIGHTSHIFT_CTRL, LIGHTSHIFT_ALT or LIGHTSHIFT_GUI
+ *         is defined
+ */
+inline bool lghts_mod_classes(void) {
+    #if defined(LIGHTSHIFT_CTRL) || defined(LIGHTSHIFT_ALT) \
+        || defined(LIGHTSHIFT_GUI)
+        return true;
+    #else
+        return false;
+    #endif
+}
+
+
+/**
+ * @brief Returns the class of a mod-tap key
+ * 
+ * @param keycode Keycode that may be a tracked mod-tap
+ * 
+ * @return class, or LGHTS_CLASS_NONE if not a mod-tap of an enabled class
+ */
+lightshift_class_t lghts_mod_class(uint16_t keycode);
+
+
+/**
+ * @brief Returns the configured tapping term of a (non-shift) class
+ * 
+ * @param mod_class LGHTS_CLASS_CTRL, LGHTS_CLASS_ALT or LGHTS_CLASS_GUI
+ * @param extended true for the extended tapping term
+ * 
+ * @return term in ms (TAPPING_TERM for any other class)
+ */
+uint16_t lghts_class_term(lightshift_class_t mod_class, bool extended);
@@ -0,0 +1,237 @@
+#include "lightshift_profiles.h"
+#include "lightshift_debug.h"
+
+#ifdef LIGHTSHIFT_PROFILES
+
+_Static_assert(sizeof(lightshift_profiles_t) == LIGHTSHIFT_PROFILES_SIZE,
+               "lightshift_profiles_t must match LIGHTSHIFT_PROFILES_SIZE");
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// State
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// all zero: every key on profile 0, i.e. global terms
+static lightshift_profiles_t profiles = {0};
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Persistence
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#if defined(EECONFIG_USER_DATA_SIZE) && EECONFIG_USER_DATA_SIZE \
+    >= LIGHTSHIFT_PROFILES_EEPROM_OFFSET + LIGHTSHIFT_PROFILES_SIZE
+
+    __attribute__((weak)) bool lightshift_load_profiles(
+                                          lightshift_profiles_t *profiles) {
+        eeconfig_read_user_datablock(profiles,
+                                     LIGHTSHIFT_PROFILES_EEPROM_OFFSET,
+                                     LIGHTSHIFT_PROFILES_SIZE);
+        return profiles->magic == LIGHTSHIFT_PROFILES_MAGIC
+               && profiles->rows == MATRIX_ROWS
+               && profiles->cols == MATRIX_COLS;
+    }
+
+    __attribute__((weak)) void lightshift_save_profiles(
+                                    const lightshift_profiles_t *profiles) {
+        eeconfig_update_user_datablock(profiles,
+                                       LIGHTSHIFT_PROFILES_EEPROM_OFFSET,
+                                       LIGHTSHIFT_PROFILES_SIZE);
+    }
+
+#else // no EEPROM space: profiles last until power off
+
+    __attribute__((weak)) bool lightshift_load_profiles(
+                                          lightshift_profiles_t *profiles) {
+        return false;
+    }
+
+    __attribute__((weak)) void lightshift_save_profiles(
+                                    const lightshift_profiles_t *profiles) {}
+
+#endif
+
+
+void lghts_profiles_init(void) {
+    if (!lightshift_load_profiles(&profiles)) {
+        memset(&profiles, 0, sizeof(profiles));
+    }
+    profiles.magic = LIGHTSHIFT_PROFILES_MAGIC;
+    profiles.rows = MATRIX_ROWS;
+    profiles.cols = MATRIX_COLS;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Lookup
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Profile number for a position
+static uint8_t get_profile(uint8_t row, uint8_t col) {
+    uint16_t i = row * MATRIX_COLS + col;
+    return (profiles.map[i >> 1] >> ((i & 1) * 4)) & 0x0F;
+}
+
+
+static void set_profile(uint8_t row, uint8_t col, uint8_t profile) {
+    uint16_t i = row * MATRIX_COLS + col;
+    uint8_t shift = (i & 1) * 4;
+    profiles.map[i >> 1] = (profiles.map[i >> 1] & ~(0x0F << shift))
+                           | (profile << shift);
+}
+
+
+uint16_t lghts_profile_term(keypos_t key, bool extended) {
+    if (key.row >= MATRIX_ROWS || key.col >= MATRIX_COLS) return 0;
+    uint8_t profile = get_profile(key.row, key.col);
+    if (profile == 0 || profile >= LIGHTSHIFT_PROFILE_COUNT) return 0;
+    return profiles.terms[profile][extended ? 1 : 0];
+}
+
+
+// (raw HID is only built with RAW_ENABLE; without it, profiles are still
+//  loaded at boot, e.g. from your own lightshift_load_profiles())
+#ifdef RAW_ENABLE
+
+#include "raw_hid.h"
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Raw HID Protocol
+//
+// Requests & replies are single reports.  Requests start with
+// LIGHTSHIFT_HID_ID, then a command byte.  Replies echo both, then a status
+// byte (0 = ok), then any data.  16-bit values are little-endian.
+//
+//   GET_INFO                    -> version, rows, cols, profile count
+//   GET_PROFILE  profile        -> term (2), extended term (2)
+//   SET_PROFILE  profile term(2) extended(2)
+//   GET_MAP      offset         -> up to 28 bytes of map from offset
+//   SET_KEY      row col profile
+//   SAVE                           (writes profiles to EEPROM)
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#define LIGHTSHIFT_HID_ID 0x4C // 'L'
+#define PROTOCOL_VERSION 1
+
+enum {
+    CMD_GET_INFO = 1,
+    CMD_GET_PROFILE,
+    CMD_SET_PROFILE,
+    CMD_GET_MAP,
+    CMD_SET_KEY,
+    CMD_SAVE,
+};
+
+#define STATUS_OK 0
+#define STATUS_ERROR 1
+
+#define REPLY_DATA 3 // first data byte of a reply
+#define MAX_MAP_CHUNK 28
+#define MAX_ARGS 5 // SET_PROFILE
+
+
+static uint16_t read_u16(const uint8_t *p) {
+    return p[0] | (p[1] << 8);
+}
+
+
+static void write_u16(uint8_t *p, uint16_t value) {
+    p[0] = value & 0xFF;
+    p[1] = value >> 8;
+}
+
+
+// Carries out a command, writing any reply data; returns the reply status
+static uint8_t run_command(uint8_t command, const uint8_t *arg,
+                           uint8_t *reply) {
+    switch (command) {
+        case CMD_GET_INFO:
+            reply[0] = PROTOCOL_VERSION;
+            reply[1] = MATRIX_ROWS;
+            reply[2] = MATRIX_COLS;
+            reply[3] = LIGHTSHIFT_PROFILE_COUNT;
+            return STATUS_OK;
+
+        case CMD_GET_PROFILE: {
+            uint8_t profile = arg[0];
+            if (profile >= LIGHTSHIFT_PROFILE_COUNT) return STATUS_ERROR;
+            write_u16(&reply[0], profiles.terms[profile][0]);
+            write_u16(&reply[2], profiles.terms[profile][1]);
+            return STATUS_OK;
+        }
+
+        case CMD_SET_PROFILE: {
+            uint8_t profile = arg[0];
+            if (profile == 0 || profile >= LIGHTSHIFT_PROFILE_COUNT) {
+                return STATUS_ERROR; // profile 0 is always the global terms
+            }
+            profiles.terms[profile][0] = read_u16(&arg[1]);
+            profiles.terms[profile][1] = read_u16(&arg[3]);
+            lghts_dprintf("Profile %u: TT %u, ETT %u", profile,
+                          profiles.terms[profile][0],
+                          profiles.terms[profile][1]);
+            return STATUS_OK;
+        }
+
+        case CMD_GET_MAP: {
+            uint8_t offset = arg[0];
+            if (offset >= LIGHTSHIFT_PROFILE_MAP_SIZE) return STATUS_ERROR;
+            uint8_t n = LIGHTSHIFT_PROFILE_MAP_SIZE - offset;
+            if (n > MAX_MAP_CHUNK) n = MAX_MAP_CHUNK;
+            memcpy(reply, &profiles.map[offset], n);
+            return STATUS_OK;
+        }
+
+        case CMD_SET_KEY: {
+            uint8_t row = arg[0], col = arg[1], profile = arg[2];
+            if (row >= MATRIX_ROWS || col >= MATRIX_COLS
+                    || profile >= LIGHTSHIFT_PROFILE_COUNT) {
+                return STATUS_ERROR;
+            }
+            set_profile(row, col, profile);
+            return STATUS_OK;
+        }
+
+        case CMD_SAVE:
+            lightshift_save_profiles(&profiles);
+            return STATUS_OK;
+
+        default:
+            return STATUS_ERROR;
+    }
+}
+
+
+bool lightshift_raw_hid_receive(uint8_t *data, uint8_t length) {
+    if (length < REPLY_DATA + MAX_MAP_CHUNK || data[0] != LIGHTSHIFT_HID_ID) {
+        return false;
+    }
+
+    // the reply overwrites the arguments, so keep a copy
+    uint8_t arg[MAX_ARGS];
+    memcpy(arg, &data[2], MAX_ARGS);
+    memset(&data[2], 0, length - 2);
+
+    data[2] = run_command(data[1], arg, &data[REPLY_DATA]);
+    raw_hid_send(data, length);
+    return true;
+}
+
+#endif // RAW_ENABLE
+
+#else
+
+void lghts_profiles_init(void) {}
+
+uint16_t lghts_profile_term(keypos_t key, bool extended) {
+    return 0;
+}
+
+#endif
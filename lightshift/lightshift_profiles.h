@@ -0,0 +1,121 @@
+/**
+ * lightshift_profiles.h
+ * 
+ * Term profiles give individual shift keys their own tapping terms, e.g. a
+ * longer term for a pinky shift than for an index-finger shift.
+ * 
+ * There are LIGHTSHIFT_PROFILE_COUNT profiles, each a (lightshift term,
+ * extended term) pair, and each matrix position is assigned one profile.
+ * Profile 0 (the default for every key) and any term of 0 mean "use the
+ * global term".  Profiles and assignments are kept in RAM (a 4-bit profile
+ * number per position), loaded from EEPROM at boot, and, with RAW_ENABLE,
+ * can be read and written live over raw HID (see
+ * lightshift_raw_hid_receive() and tools/lightshift_hid.py).
+ * 
+ * Enable with LIGHTSHIFT_PROFILES in config.h.
+ * 
+ */
+
+#pragma once
+#include "quantum.h"
+#include "lightshift_tuning.h"
+
+#ifndef LIGHTSHIFT_PROFILE_COUNT
+    #define LIGHTSHIFT_PROFILE_COUNT 4
+#endif
+#if LIGHTSHIFT_PROFILE_COUNT < 2 || LIGHTSHIFT_PROFILE_COUNT > 16
+    #error "LIGHTSHIFT_PROFILE_COUNT must be 2 to 16"
+#endif
+
+// profile number per position: 4 bits each (rounded to an even size)
+#define LIGHTSHIFT_PROFILE_MAP_SIZE (((MATRIX_ROWS * MATRIX_COLS + 3) / 4) * 2)
+
+// magic (2 bytes) + matrix rows & cols (2) + 2 terms per profile + map
+#define LIGHTSHIFT_PROFILES_SIZE \
+    (4 + 4 * LIGHTSHIFT_PROFILE_COUNT + LIGHTSHIFT_PROFILE_MAP_SIZE)
+
+// location in the user EEPROM datablock (after any self-tuned terms)
+#ifndef LIGHTSHIFT_PROFILES_EEPROM_OFFSET
+    #define LIGHTSHIFT_PROFILES_EEPROM_OFFSET \
+        (LIGHTSHIFT_TUNING_EEPROM_OFFSET + LIGHTSHIFT_TERMS_SIZE)
+#endif
+
+// "LP", with the profile count in the low nibble: profiles saved with another
+// count (or matrix, see below) have another layout, so aren't loaded
+#define LIGHTSHIFT_PROFILES_MAGIC (0x4C50 | (LIGHTSHIFT_PROFILE_COUNT - 1))
+
+/**
+ * @brief Convenience method for access to LIGHTSHIFT_PROFILES parameter
+ */
+inline bool lghts_profiles(void) {
+    #ifdef LIGHTSHIFT_PROFILES
+        return true;
+    #else
+        return false;
+    #endif
+}
+
+
+/**
+ * @brief Term profiles & assignments, as saved to EEPROM
+ */
+typedef struct {
+    uint16_t magic;                                  ///< ..._PROFILES_MAGIC
+    uint8_t rows;                                    ///< MATRIX_ROWS
+    uint8_t cols;                                    ///< MATRIX_COLS
+    uint16_t terms[LIGHTSHIFT_PROFILE_COUNT][2];     ///< [profile][0 or 1]
+                                                     ///< 0: lightshift term
+                                                     ///< 1: extended term
+    uint8_t map[LIGHTSHIFT_PROFILE_MAP_SIZE];        ///< 4-bit profile / key
+} lightshift_profiles_t;
+
+
+/**
+ * @brief Loads saved profiles
+ * 
+ * By default, reads the EEPROM user datablock (if EECONFIG_USER_DATA_SIZE is
+ * large enough).  Override to store the profiles elsewhere.
+ * 
+ * @return true if profiles were loaded
+ */
+bool lightshift_load_profiles(lightshift_profiles_t *profiles);
+
+
+/**
+ * @brief Saves profiles
+ * 
+ * By default, writes the EEPROM user datablock (if EECONFIG_USER_DATA_SIZE
+ * is large enough).  Override to store the profiles elsewhere.
+ */
+void lightshift_save_profiles(const lightshift_profiles_t *profiles);
+
+
+#ifdef RAW_ENABLE
+/**
+ * @brief Handles a raw HID report, if it's a Lightshift profile command
+ * 
+ * Called automatically if RAW_ENABLE is on (without VIA), unless
+ * LIGHTSHIFT_USER_RAW_HID is defined, in which case call it from your own
+ * raw_hid_receive().  Replies in place with raw_hid_send().
+ * 
+ * @return true if the report was a Lightshift command
+ */
+bool lightshift_raw_hid_receive(uint8_t *data, uint8_t length);
+#endif
+
+
+/**
+ * @brief Loads saved profiles; call from keyboard_post_init
+ */
+void lghts_profiles_init(void);
+
+
+/**
+ * @brief Profile term for a key; O(1)
+ * 
+ * @param key Key position
+ * @param extended true for the extended term, false for the lightshift term
+ * 
+ * @return term in ms, or 0 to use the global term
+ */
+uint16_t lghts_profile_term(keypos_t key, bool extended);
@@ -1,5 +1,7 @@
 #include "lightshift_state.h"
 #include "lightshift_debug.h"
+#include "lightshift_stats.h"
+#include "lightshift_mods.h"
 
 ///////////////////////////////////////////////////////////////////////////////
 //
@@ -7,19 +9,67 @@
 //
 ///////////////////////////////////////////////////////////////////////////////
 
-// # of simult. MT shift presses; any more will be normal MTs, not lightshifts
-#define MAX_TRACKED_SHIFTS 2 // very rare to have > 2 home-row shift keys
-                             // even rarer to press > 2 at the same time
-                             
-// array of current shift presses
-static shift_t shift_keys[MAX_TRACKED_SHIFTS];
-static uint8_t shifts_count = 0;
+// # of simult. MT shift presses (LIGHTSHIFT_MAX_TRACKED, default 2):
+// very rare to have > 2 home-row shift keys, even rarer to press > 2 at once
+#define MAX_TRACKED_SHIFTS LIGHTSHIFT_MAX_TRACKED
+
+// slots: shifts first, then those of each other tracked class of mod
+#define TRACKED_SLOTS (MAX_TRACKED_SHIFTS + LGHTS_CTRL_SLOTS \
+                       + LGHTS_ALT_SLOTS + LGHTS_GUI_SLOTS)
+
+// a matrix position, as an index: row * MATRIX_COLS + col
+// (the top value is reserved for the key outside the matrix, if any)
+#if MATRIX_ROWS * MATRIX_COLS < 256
+    typedef uint8_t position_t;
+#else
+    typedef uint16_t position_t;
+#endif
+#define OFF_MATRIX ((position_t)~0)
+
+// a tracked shift, packed (3 bytes on most keyboards): the keycode isn't
+// stored, as the keymap gives it when needed - see lghts_get_keycode()
+typedef struct {
+    position_t position;   // matrix position index
+    uint8_t state : 3;     // lightshift_state_t
+    int8_t term_adjust;    // contextual tapping term adjustment (ms)
+} packed_shift_t;
+_Static_assert(LIGHTSHIFT_STATE_COUNT <= 8,
+               "Lightshift states must fit in 3 bits");
+
+// slots for current shift presses (a shift keeps its slot until released)
+static packed_shift_t shift_keys[TRACKED_SLOTS];
+
+// the slots reserved for each class
+#define SLOT_RANGE(first, count) \
+    ((uint8_t)(((1u << (count)) - 1) << (first)))
+static const uint8_t class_slots[LIGHTSHIFT_CLASS_COUNT] = {
+    [LGHTS_CLASS_SHIFT] = SLOT_RANGE(0, MAX_TRACKED_SHIFTS),
+    [LGHTS_CLASS_CTRL]  = SLOT_RANGE(MAX_TRACKED_SHIFTS, LGHTS_CTRL_SLOTS),
+    [LGHTS_CLASS_ALT]   = SLOT_RANGE(MAX_TRACKED_SHIFTS + LGHTS_CTRL_SLOTS,
+                                     LGHTS_ALT_SLOTS),
+    [LGHTS_CLASS_GUI]   = SLOT_RANGE(MAX_TRACKED_SHIFTS + LGHTS_CTRL_SLOTS
+                                     + LGHTS_ALT_SLOTS, LGHTS_GUI_SLOTS),
+};
+
+// indexes into the slots, so the common questions need no scan:
+// - which slots are in use?
+// - which slots are in a given state? (e.g. "any UNRESOLVED?")
+// - is a shift being tracked at this matrix position?
+static uint8_t occupied_slots = 0;
+static uint8_t state_slots[LIGHTSHIFT_STATE_COUNT] = {0};
+static matrix_row_t tracked_positions[MATRIX_ROWS] = {0};
+
+// a key outside the matrix (e.g. a combo) can't be stored as a position, so
+// one at a time is tracked here, with its keycode as the keymap can't give it
+static uint8_t off_matrix_slot = LGHTS_NO_SLOT;
+static keypos_t off_matrix_key;
+static uint16_t off_matrix_keycode;
 
 // sentinel value, in case requested shift data not in state array
-#define SHIFT_NO UINT8_MAX
-// check MAX_TRACKED_SHIFTS < SHIFT_NO (to avoid interfering with sentinel)
-_Static_assert(MAX_TRACKED_SHIFTS < SHIFT_NO, 
-               "MAX_TRACKED_SHIFTS must be no more than 254");
+#define SHIFT_NO LGHTS_NO_SLOT
+// each slot is one bit of a uint8_t slot mask (also keeps slots < SHIFT_NO)
+_Static_assert(TRACKED_SLOTS <= 8,
+               "Lightshift can track no more than 8 mod-taps in all");
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -38,6 +88,7 @@ _Static_assert(MAX_TRACKED_SHIFTS < SHIFT_NO,
       "RELEASED, EXTENDED",
       "SINGLE SHIFTING",
       "DOUBLE SHIFTING",
+      "STREAK TAP",
     };
 
     // @brief Generates a text representation for a given enum state
@@ -59,36 +110,94 @@ _Static_assert(MAX_TRACKED_SHIFTS < SHIFT_NO,
 #endif
 
 
+///////////////////////////////////////////////////////////////////////////////
+//
+// Positions
+//
+///////////////////////////////////////////////////////////////////////////////
+
+static inline bool in_matrix(keypos_t key) {
+    return key.row < MATRIX_ROWS && key.col < MATRIX_COLS;
+}
+
+static inline position_t to_position(keypos_t key) {
+    return (position_t)(key.row * MATRIX_COLS + key.col);
+}
+
+static inline keypos_t to_key(position_t position) {
+    if (position == OFF_MATRIX) return off_matrix_key;
+    keypos_t key = {.row = position / MATRIX_COLS,
+                    .col = position % MATRIX_COLS};
+    return key;
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////
 //
 // Getters
 //
 ///////////////////////////////////////////////////////////////////////////////
 
-// Returns tracking data for the lightshift at index
-shift_t get_lghts(uint8_t index) {
-    // Return not a valid index, return INACTIVE shift
-    if (index >= shifts_count) {
-        shift_t inactive = {0};
-        inactive.keycode = KC_NO;
-        inactive.state = SHIFT_INACTIVE;
-        return inactive;        
+// Returns tracking data for the lightshift in slot
+shift_t get_lghts(uint8_t slot) {
+    shift_t shift = {0};
+    // if slot not in use, return INACTIVE shift
+    if (slot >= TRACKED_SLOTS || !(occupied_slots & (1 << slot))) {
+        shift.state = SHIFT_INACTIVE;
+        return shift;
     }
-    return shift_keys[index];
+    shift.key = to_key(shift_keys[slot].position);
+    shift.state = (lightshift_state_t)shift_keys[slot].state;
+    shift.term_adjust = shift_keys[slot].term_adjust;
+    return shift;
+}
+
+
+// returns a bitmask of the slots in use
+uint8_t lghts_active_slots(void) {
+    return occupied_slots;
 }
 
 
 // returns the number of active lightshifts
 uint8_t num_active_lghts(void) {
-    return shifts_count;
+    uint8_t count = 0;
+    for (uint8_t slots = occupied_slots; slots; slots &= slots - 1) {
+        lghts_probe_iteration();
+        count++;
+    }
+    return count;
+}
+
+
+// returns a bitmask of the slots whose shifts are in the given state
+uint8_t lghts_slots_in_state(lightshift_state_t state) {
+    if (state == SHIFT_INACTIVE || state >= LIGHTSHIFT_STATE_COUNT) return 0;
+    return state_slots[state];
 }
 
 
-// Returns the shift_keys array index for the given record
+// Is a shift tracked at this position?
+static inline bool position_tracked(keypos_t key) {
+    if (!in_matrix(key)) {
+        return off_matrix_slot != SHIFT_NO && KEYEQ(off_matrix_key, key);
+    }
+    return tracked_positions[key.row] & ((matrix_row_t)1 << key.col);
+}
+
+
+// Returns the shift_keys slot for the given key
 // Returns SHIFT_NO if this is not a tracked shift key
-static uint8_t get_index(keypos_t key) {
-    for (uint8_t i = 0; i < shifts_count; i++) {
-        if (KEYEQ(shift_keys[i].key, key)) {
+static uint8_t get_slot(keypos_t key) {
+    // common case: no shifts pressed, or not a shift => no scan
+    if (!occupied_slots || !position_tracked(key)) return SHIFT_NO;
+    if (!in_matrix(key)) return off_matrix_slot;
+
+    position_t position = to_position(key);
+    for (uint8_t i = 0; i < TRACKED_SLOTS; i++) {
+        lghts_probe_iteration();
+        if ((occupied_slots & (1 << i))
+                && shift_keys[i].position == position) {
             return i;
         }
     }
@@ -96,11 +205,59 @@ static uint8_t get_index(keypos_t key) {
 }
 
 
+// Returns the slot of a given shift key (SHIFT_NO if untracked)
+uint8_t lghts_find_slot(keypos_t key) {
+    return get_slot(key);
+}
+
+
+// Returns the key of the shift in a slot
+keypos_t lghts_slot_key(uint8_t slot) {
+    return to_key(shift_keys[slot].position);
+}
+
+
+// Returns the state of the shift in a slot (INACTIVE if none)
+lightshift_state_t lghts_slot_state(uint8_t slot) {
+    if (slot >= TRACKED_SLOTS || !(occupied_slots & (1 << slot))) {
+        return SHIFT_INACTIVE;
+    }
+    return (lightshift_state_t)shift_keys[slot].state;
+}
+
+
+// Returns the keycode of the shift in a slot, from the keymap
+// (the source layer cache gives the layer it was pressed on)
+uint16_t lghts_slot_keycode(uint8_t slot) {
+    if (slot >= TRACKED_SLOTS || !(occupied_slots & (1 << slot))) {
+        return KC_NO;
+    }
+    if (slot == off_matrix_slot) return off_matrix_keycode;
+    keyevent_t event = {.key = to_key(shift_keys[slot].position),
+                        .pressed = true, .type = KEY_EVENT};
+    return get_event_keycode(event, false);
+}
+
+
 // Returns the current state for a given shift key
 lightshift_state_t lghts_get_state(keypos_t key) {
-    uint8_t index = get_index(key);
-    if (index == SHIFT_NO) return SHIFT_INACTIVE;
-    return shift_keys[index].state;
+    uint8_t slot = get_slot(key);
+    if (slot == SHIFT_NO) return SHIFT_INACTIVE;
+    return (lightshift_state_t)shift_keys[slot].state;
+}
+
+
+// Returns the tapping term adjustment for a given shift key
+int8_t lghts_get_term_adjust(keypos_t key) {
+    uint8_t slot = get_slot(key);
+    if (slot == SHIFT_NO) return 0;
+    return shift_keys[slot].term_adjust;
+}
+
+
+// Returns the keycode of a given shift key, from the keymap
+uint16_t lghts_get_keycode(keypos_t key) {
+    return lghts_slot_keycode(get_slot(key));
 }
 
 
@@ -110,21 +267,34 @@ bool is_lightshift(const uint16_t keycode) {
 }
 
 
+// Returns true if this is a mod-tap Lightshift tracks: a shift, or a mod-tap
+// of another enabled class
+bool is_lightshift_mod(const uint16_t keycode) {
+    if (!lghts_mod_classes()) return is_lightshift(keycode);
+    return lghts_mod_class(keycode) != LGHTS_CLASS_NONE;
+}
+
+
+// returns a bitmask of the slots reserved for a class
+uint8_t lghts_class_slots(lightshift_class_t mod_class) {
+    return mod_class < LIGHTSHIFT_CLASS_COUNT ? class_slots[mod_class] : 0;
+}
+
+
 // Returns true if the key is a tracked lightshift
 bool is_tracked_lghts(keypos_t key) {
-    return get_index(key) != SHIFT_NO;
+    return get_slot(key) != SHIFT_NO;
 }
 
 
 // Returns true if the key is a lightshift that should use an Extended TT
+// (called continuously while tap-hold decisions are pending)
 bool lghts_use_extended_tt(keypos_t key) {
-    for (uint8_t i = 0; i < shifts_count; i++) {
-        if (KEYEQ(shift_keys[i].key, key)) {
-            return (shift_keys[i].state == SHIFT_EXTENDED_TT
-                 || shift_keys[i].state == SHIFT_RELEASED_EXTENDED);
-        }
-    }
-    return false;
+    uint8_t extended = state_slots[SHIFT_EXTENDED_TT]
+                     | state_slots[SHIFT_RELEASED_EXTENDED];
+    if (!extended) return false;
+    uint8_t slot = get_slot(key);
+    return slot != SHIFT_NO && (extended & (1 << slot));
 }
 
 
@@ -134,37 +304,125 @@ bool lghts_use_extended_tt(keypos_t key) {
 //
 ///////////////////////////////////////////////////////////////////////////////
 
-// Start tracking a new lightshift keypress; returns the index of the newly
+// Mark a position as tracked (or untracked) in the position index
+static void index_position(keypos_t key, bool tracked) {
+    if (!in_matrix(key)) return;
+    if (tracked) {
+        tracked_positions[key.row] |= ((matrix_row_t)1 << key.col);
+    }
+    else {
+        tracked_positions[key.row] &= ~((matrix_row_t)1 << key.col);
+    }
+}
+
+
+// Move a tracked shift into a new state, keeping the state index up to date
+static void move_slot(uint8_t slot, lightshift_state_t state) {
+    state_slots[shift_keys[slot].state] &= ~(1 << slot);
+    state_slots[state] |= (1 << slot);
+    shift_keys[slot].state = state;
+}
+
+
+// Start tracking a new lightshift keypress; returns the slot of the newly
 // added shift, or SHIFT_NO if the shift could not be added
-static uint8_t add_shift(keypos_t shift_key, uint16_t keycode) {
-    
-    // no action if no space in state array
-    if (shifts_count >= MAX_TRACKED_SHIFTS) {
-        lghts_dprintf("WARNING: Max shifts (%d) exceeded", MAX_TRACKED_SHIFTS);
+static uint8_t add_shift(keypos_t shift_key, uint16_t keycode,
+                         lightshift_state_t state) {
+
+    // only one key outside the matrix (e.g. a combo) can be tracked at once
+    if (!in_matrix(shift_key) && off_matrix_slot != SHIFT_NO) {
+        lghts_dprintf("WARNING: Max tracked %s exceeded",
+                      get_keycode_string(keycode));
+        if (lghts_stats()) lghts_stats_overflow();
+        return SHIFT_NO;
+    }
+
+    // find a free slot among those reserved for the key's class
+    uint8_t free_slots = lghts_class_slots(lghts_mod_class(keycode))
+                         & ~occupied_slots;
+
+    // no action if no free slot
+    if (!free_slots) {
+        lghts_dprintf("WARNING: Max tracked %s exceeded",
+                      get_keycode_string(keycode));
+        if (lghts_stats()) lghts_stats_overflow();
         return SHIFT_NO;
     }
 
-    // add new shift to state array
-    shift_keys[shifts_count].key = shift_key;
-    shift_keys[shifts_count].keycode = keycode;
-    shift_keys[shifts_count].state = SHIFT_UNRESOLVED;
-    shifts_count++;
-    return shifts_count - 1;
+    uint8_t slot = 0;
+    while (!(free_slots & 1)) {
+        lghts_probe_iteration();
+        free_slots >>= 1;
+        slot++;
+    }
+
+    // add new shift to slot
+    if (in_matrix(shift_key)) {
+        shift_keys[slot].position = to_position(shift_key);
+    }
+    else {
+        shift_keys[slot].position = OFF_MATRIX;
+        off_matrix_slot = slot;
+        off_matrix_key = shift_key;
+        off_matrix_keycode = keycode;
+    }
+    shift_keys[slot].state = SHIFT_INACTIVE;
+    shift_keys[slot].term_adjust = 0;
+    move_slot(slot, state);
+    if (lghts_stats()) lghts_stats_transition(state);
+    occupied_slots |= (1 << slot);
+    index_position(shift_key, true);
+    return slot;
 }
 
 
 // Stop tracking an old lightshift keypress
-static void remove_shift(uint8_t index) {
-    if (shifts_count == 0 || index >= shifts_count) return;
-    for (uint8_t i = index; i < shifts_count - 1; i++) {
-        shift_keys[i] = shift_keys[i + 1];
+static void remove_shift(uint8_t slot) {
+    if (slot >= TRACKED_SLOTS || !(occupied_slots & (1 << slot))) return;
+    state_slots[shift_keys[slot].state] &= ~(1 << slot);
+    occupied_slots &= ~(1 << slot);
+    index_position(to_key(shift_keys[slot].position), false);
+    if (slot == off_matrix_slot) off_matrix_slot = SHIFT_NO;
+}
+
+
+// Start tracking a new lightshift press (in state UNRESOLVED or STREAK TAP)
+// (the caller already has the keycode, so no keymap lookup is needed)
+uint8_t lghts_start_tracking(keypos_t key, uint16_t keycode,
+                             lightshift_state_t state) {
+    if (state == SHIFT_INACTIVE || state >= LIGHTSHIFT_STATE_COUNT) {
+        return SHIFT_NO;
     }
-    shifts_count--;
+    uint8_t slot = add_shift(key, keycode, state);
+    if (slot != SHIFT_NO) {
+        lghts_dprintf("%s - state: %s", get_keycode_string(keycode),
+                      state_debug_text(state));
+    }
+    return slot;
+}
+
+
+// Update a specific lightshift's tapping term adjustment
+void lghts_set_term_adjust(keypos_t key, int8_t adjust) {
+    lghts_set_slot_term_adjust(get_slot(key), adjust);
 }
 
 
-// Update a specific lightshift's state, or start / stop tracking it
+// Update the tapping term adjustment of the shift in a slot
+void lghts_set_slot_term_adjust(uint8_t slot, int8_t adjust) {
+    if (slot >= TRACKED_SLOTS || !(occupied_slots & (1 << slot))) return;
+    shift_keys[slot].term_adjust = adjust;
+}
+
+
+// Update a specific lightshift's state, or stop tracking it
 void lghts_set_state(keypos_t key, lightshift_state_t state) {
+    lghts_set_slot_state(get_slot(key), state);
+}
+
+
+// Update the state of the shift in a slot, or stop tracking it
+void lghts_set_slot_state(uint8_t slot, lightshift_state_t state) {
 
     // if invalid state, ignore & warn
     if (state >= LIGHTSHIFT_STATE_COUNT) {
@@ -173,31 +431,21 @@ void lghts_set_state(keypos_t key, lightshift_state_t state) {
     }
 
     // if shift is untracked, ignore
-    uint8_t shift_index = get_index(key);
-    if (shift_index == SHIFT_NO && state != SHIFT_UNRESOLVED) return;
-    
-    uint16_t keycode;
+    if (slot >= TRACKED_SLOTS || !(occupied_slots & (1 << slot))) return;
 
-    // start tracking new shift presses
-    if (state == SHIFT_UNRESOLVED) {
-        keycode = layer_switch_get_action(key).code;
-        shift_index = add_shift(key, keycode);
-    }
+    // debug logging (while the keycode can still be looked up)
+    lghts_dprintf("%s - state: %s",
+                  get_keycode_string(lghts_slot_keycode(slot)),
+                  state_debug_text(state));
 
     // stop tracking old shift presses
-    else if (state == SHIFT_INACTIVE) {
-        remove_shift(shift_index);
+    if (state == SHIFT_INACTIVE) {
+        remove_shift(slot);
     }
 
     // update state normally
     else {
-        shift_keys[shift_index].state = state;
-    }
-
-    // debug logging
-    if (shift_index != SHIFT_NO) {
-        keycode = shift_keys[shift_index].keycode;
-        lghts_dprintf("%s - state: %s", get_keycode_string(keycode),
-                      state_debug_text(state));
+        move_slot(slot, state);
     }
+    if (lghts_stats()) lghts_stats_transition(state);
 }
@@ -6,6 +6,7 @@
 
 #pragma once
 #include "quantum.h"
+#include "lightshift_mods.h"
 
 typedef enum {
     SHIFT_INACTIVE,                // Not pressed, or Cleared (or not tracked)
@@ -15,26 +16,60 @@ typedef enum {
     SHIFT_RELEASED_EXTENDED,       // Just released, use Extended TT
     SHIFT_SINGLE_SHIFTING,         // Held; not yet consumed
     SHIFT_DOUBLE_SHIFTING,         // Held; already consumed, only doubles left
+    SHIFT_STREAK_TAP,              // Pressed in a typing streak, tapped at once
     LIGHTSHIFT_STATE_COUNT,
   // Update debug messages in lightshift_state.c when changing
 } lightshift_state_t;
 
+// slot number for "no slot", e.g. an untracked key
+#define LGHTS_NO_SLOT UINT8_MAX
+
 // Maps a physical shift key to its current lightshift state
+// (unpacked from storage; for the keycode, see lghts_get_keycode())
 typedef struct {
     keypos_t key;             ///< physical key location
-    uint16_t keycode;         ///< keycode
     lightshift_state_t state; ///< current state: pressed? which tt?
+    int8_t term_adjust;       ///< contextual tapping term adjustment (ms)
 } shift_t;
 
 /**
- * @brief Returns state data for the active lightshift at index
+ * @brief Returns state data for the active lightshift in slot
+ * 
+ * Tracked lightshifts keep the same slot from press to release.  Find the
+ * slots of interest with lghts_slots_in_state().
  * 
- * @param index index of the active lightshift for which state data is needed
+ * @param slot slot of the active lightshift for which state data is needed
  *
- * @return state data, including state, keycode and key
- *         (or SHIFT_INACTIVE, KC_NO if no lightshift at index)
+ * @return state data, including state and key
+ *         (or SHIFT_INACTIVE if no lightshift in slot)
  */
-shift_t get_lghts(uint8_t index);
+shift_t get_lghts(uint8_t slot);
+
+
+/**
+ * @brief Returns the slots of all lightshifts in the given state
+ * 
+ * Use to test for a state without a scan, e.g.
+ *     if (lghts_slots_in_state(SHIFT_UNRESOLVED)) { ... }
+ * 
+ * @param state state of interest (other than SHIFT_INACTIVE)
+ * 
+ * @return bitmask of slots (bit n set => slot n is in state)
+ */
+uint8_t lghts_slots_in_state(lightshift_state_t state);
+
+
+/**
+ * @brief Returns the slots of all active lightshifts
+ * 
+ * Use to test for any active lightshift without counting, or to visit each
+ * tracked shift once, e.g.
+ *     for (uint8_t i = 0, slots = lghts_active_slots(); slots;
+ *          i++, slots >>= 1) { if (slots & 1) ... }
+ * 
+ * @return bitmask of slots (bit n set => slot n is in use)
+ */
+uint8_t lghts_active_slots(void);
 
 
 /**
@@ -46,10 +81,23 @@ uint8_t num_active_lghts(void);
 
 
 /**
- * @brief Update a specific lshift's state, or add/remove a press to/from state
+ * @brief Add a new shift press to state
+ * 
+ * @param key Key position of the newly pressed lightshift
+ * @param keycode Keycode of the newly pressed lightshift
+ * @param state first state: SHIFT_UNRESOLVED, or SHIFT_STREAK_TAP
+ * 
+ * @return slot of the new shift, or LGHTS_NO_SLOT if it can't be tracked
+ */
+uint8_t lghts_start_tracking(keypos_t key, uint16_t keycode,
+                             lightshift_state_t state);
+
+
+/**
+ * @brief Update a specific lshift's state, or remove a press from state
  * 
- * Pass in SHIFT_UNRESOLVED to add a new shift press, or
- * SHIFT_INACTIVE to remove an old shift press.
+ * Pass in SHIFT_INACTIVE to remove an old shift press.  Untracked keys are
+ * ignored; use lghts_start_tracking() to add a new shift press.
  * 
  * @param key Key position of the lightshift to be updated
  * @param state desired state enum (above)
@@ -57,6 +105,80 @@ uint8_t num_active_lghts(void);
 void lghts_set_state(keypos_t key, lightshift_state_t state);
 
 
+///////////////////////////////////////////////////////////////////////////////
+//
+// Slot Access
+//
+// For code visiting shifts by slot (e.g. over lghts_active_slots()): each
+// call works on the slot in place, with no search for the key.  Slots not
+// in use read as INACTIVE / KC_NO, and ignore updates.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Returns the slot of a tracked lightshift
+ * 
+ * @param key Key position of the lightshift
+ * 
+ * @return slot, or LGHTS_NO_SLOT if the key is not a tracked lightshift
+ */
+uint8_t lghts_find_slot(keypos_t key);
+
+
+/**
+ * @brief Returns the key position of the lightshift in a slot in use
+ */
+keypos_t lghts_slot_key(uint8_t slot);
+
+
+/**
+ * @brief Returns the state of the lightshift in a slot
+ */
+lightshift_state_t lghts_slot_state(uint8_t slot);
+
+
+/**
+ * @brief Returns the keycode of the lightshift in a slot
+ * 
+ * Looked up in the keymap, like lghts_get_keycode(); use sparingly.
+ */
+uint16_t lghts_slot_keycode(uint8_t slot);
+
+
+/**
+ * @brief Update the state of the lightshift in a slot, or stop tracking it
+ * 
+ * As lghts_set_state(), without the search for the key.
+ */
+void lghts_set_slot_state(uint8_t slot, lightshift_state_t state);
+
+
+/**
+ * @brief Set the contextual tapping term adjustment of the lightshift in
+ *        a slot
+ */
+void lghts_set_slot_term_adjust(uint8_t slot, int8_t adjust);
+
+
+/**
+ * @brief Set a tracked shift's contextual tapping term adjustment
+ * 
+ * @param key Key position of the lightshift to be updated
+ * @param adjust adjustment in ms, added to the shift's tapping term
+ */
+void lghts_set_term_adjust(keypos_t key, int8_t adjust);
+
+
+/**
+ * @brief Get a tracked shift's contextual tapping term adjustment
+ * 
+ * @param key Key position of the lightshift
+ * 
+ * @return adjustment in ms, or 0 if the key is not a tracked lightshift
+ */
+int8_t lghts_get_term_adjust(keypos_t key);
+
+
 /**
  * @brief Get the current state of a given shift key
  * 
@@ -67,6 +189,20 @@ void lghts_set_state(keypos_t key, lightshift_state_t state);
 lightshift_state_t lghts_get_state(keypos_t key);
 
 
+/**
+ * @brief Get the keycode of a tracked shift
+ * 
+ * Keycodes aren't stored, but looked up in the keymap, on the layer the key
+ * was pressed on (except for a key outside the matrix, e.g. a combo).  Use
+ * sparingly, e.g. not in every get_tapping_term() call.
+ * 
+ * @param key Key position of the lightshift
+ * 
+ * @return keycode, or KC_NO if the key is not a tracked lightshift
+ */
+uint16_t lghts_get_keycode(keypos_t key);
+
+
 /**
  * @brief Is this key a lightshift that should use an Extended TT?
  * 
@@ -95,6 +231,30 @@ bool lghts_use_extended_tt(keypos_t key);
 bool is_lightshift(uint16_t keycode);
 
 
+/**
+ * @brief Determines if this keycode is a mod-tap that Lightshift tracks
+ * 
+ * @param keycode Keycode that may be a tracked mod-tap
+ * 
+ * @return true if this is a mod-tap shift, or a Ctrl / Alt / GUI mod-tap
+ *         whose class is enabled (see lightshift_mods.h)
+ * 
+ * @note Use this (rather than is_lightshift()) to pick out the keys which
+ *       get Lightshift's tapping terms, e.g. in get_tapping_term().
+ */
+bool is_lightshift_mod(uint16_t keycode);
+
+
+/**
+ * @brief Returns the tracking slots reserved for a class of mod-tap
+ * 
+ * @param mod_class class of interest
+ * 
+ * @return bitmask of slots (bit n set => slot n is for this class)
+ */
+uint8_t lghts_class_slots(lightshift_class_t mod_class);
+
+
 /**
  * @brief Determines if this key is a pressed & tracked lightshift key
  * 
@@ -105,6 +265,7 @@ bool is_lightshift(uint16_t keycode);
  * @note Unlike is_lightshift(), this returns true even for released
  * 		   lightshifts that have changed keycode to a non-mod-tap shift
  *       mid-keypress.  Use it to identify lightshifts which are currently
- *       pressed.
+ *       pressed.  Of keys outside the matrix (e.g. combos), only one is
+ *       tracked at a time.
  */
 bool is_tracked_lghts(keypos_t key);
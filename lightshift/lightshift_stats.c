@@ -0,0 +1,187 @@
+#include "lightshift_stats.h"
+#include "lightshift_debug.h"
+
+#ifdef LIGHTSHIFT_STATS
+
+_Static_assert(sizeof(lightshift_stats_t) == LIGHTSHIFT_STATS_SIZE,
+               "lightshift_stats_t must match LIGHTSHIFT_STATS_SIZE");
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// State
+//
+///////////////////////////////////////////////////////////////////////////////
+
+static lightshift_stats_t stats = {0};
+
+// counts awaiting save
+static bool dirty = false;
+static uint32_t last_save = 0;
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Counters
+//
+///////////////////////////////////////////////////////////////////////////////
+
+void lghts_stats_transition(lightshift_state_t state) {
+    if (state < LIGHTSHIFT_STATE_COUNT) stats.transitions[state]++;
+    dirty = true;
+}
+
+void lghts_stats_resolution(bool same_side) {
+    if (same_side) stats.same_side++;
+    else stats.opposite_side++;
+}
+
+void lghts_stats_extended_expiry(void) {
+    stats.extended_expiries++;
+}
+
+void lghts_stats_dropshift_clear(void) {
+    stats.dropshift_clears++;
+}
+
+void lghts_stats_overflow(void) {
+    stats.overflows++;
+    dirty = true;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Persistence
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#if defined(LIGHTSHIFT_STATS_PERSIST) && defined(EECONFIG_USER_DATA_SIZE) \
+    && EECONFIG_USER_DATA_SIZE \
+       >= LIGHTSHIFT_STATS_EEPROM_OFFSET + LIGHTSHIFT_STATS_SIZE
+
+    __attribute__((weak)) bool lightshift_load_stats(
+                                                lightshift_stats_t *stats) {
+        eeconfig_read_user_datablock(stats, LIGHTSHIFT_STATS_EEPROM_OFFSET,
+                                     LIGHTSHIFT_STATS_SIZE);
+        return stats->magic == LIGHTSHIFT_STATS_MAGIC;
+    }
+
+    __attribute__((weak)) void lightshift_save_stats(
+                                          const lightshift_stats_t *stats) {
+        eeconfig_update_user_datablock(stats, LIGHTSHIFT_STATS_EEPROM_OFFSET,
+                                       LIGHTSHIFT_STATS_SIZE);
+    }
+
+#else // not persisted: counts last until power off
+
+    __attribute__((weak)) bool lightshift_load_stats(
+                                                lightshift_stats_t *stats) {
+        return false;
+    }
+
+    __attribute__((weak)) void lightshift_save_stats(
+                                          const lightshift_stats_t *stats) {}
+
+#endif
+
+
+void lghts_stats_init(void) {
+    if (!lightshift_load_stats(&stats)) {
+        memset(&stats, 0, sizeof(stats));
+    }
+    stats.magic = LIGHTSHIFT_STATS_MAGIC;
+    last_save = timer_read32();
+}
+
+
+// (every decision is also a transition, so dirty is only set there)
+void lghts_stats_task(void) {
+    if (!dirty
+        || timer_elapsed32(last_save) < LIGHTSHIFT_STATS_SAVE_INTERVAL) {
+        return;
+    }
+    lightshift_save_stats(&stats);
+    dirty = false;
+    last_save = timer_read32();
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Reporting
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// (printed names follow lightshift_state_t)
+static const char* state_names[] = {
+    "inactive", "unresolved", "lightshift tt", "extended tt",
+    "released extended", "single shifting", "double shifting",
+    "streak tap",
+};
+_Static_assert(sizeof(state_names) / sizeof(state_names[0])
+                   == LIGHTSHIFT_STATE_COUNT,
+               "state_names must match lightshift_state_t");
+
+
+const lightshift_stats_t* lightshift_get_stats(void) {
+    return &stats;
+}
+
+
+void lightshift_print_stats(void) {
+    xprintf("LIGHTSHIFT STATS\n");
+    xprintf("  Resolutions:  same side %lu, opposite side %lu\n",
+            (unsigned long)stats.same_side,
+            (unsigned long)stats.opposite_side);
+    xprintf("  Extended TT expiries: %lu\n",
+            (unsigned long)stats.extended_expiries);
+    xprintf("  Dropshift clears: %lu\n",
+            (unsigned long)stats.dropshift_clears);
+    xprintf("  Overflows: %lu\n", (unsigned long)stats.overflows);
+    xprintf("  Transitions to:\n");
+    for (uint8_t i = 0; i < LIGHTSHIFT_STATE_COUNT; i++) {
+        xprintf("    %-18s %lu\n", state_names[i],
+                (unsigned long)stats.transitions[i]);
+    }
+}
+
+
+void lightshift_reset_stats(void) {
+    memset(&stats, 0, sizeof(stats));
+    stats.magic = LIGHTSHIFT_STATS_MAGIC;
+    lightshift_save_stats(&stats);
+    dirty = false;
+    last_save = timer_read32();
+}
+
+
+bool lghts_stats_process(uint16_t keycode, const keyrecord_t *record) {
+    if (keycode != LIGHTSHIFT_PRINT_STATS) return true;
+    if (record->event.pressed) {
+        if ((get_mods() | get_oneshot_mods()) & MOD_MASK_SHIFT) {
+            lightshift_reset_stats();
+            xprintf("LIGHTSHIFT STATS reset\n");
+        }
+        else {
+            lightshift_print_stats();
+        }
+    }
+    return false;
+}
+
+#else
+
+void lghts_stats_transition(lightshift_state_t state) {}
+void lghts_stats_resolution(bool same_side) {}
+void lghts_stats_extended_expiry(void) {}
+void lghts_stats_dropshift_clear(void) {}
+void lghts_stats_overflow(void) {}
+void lghts_stats_init(void) {}
+void lghts_stats_task(void) {}
+
+// LS_STAT does nothing without LIGHTSHIFT_STATS
+bool lghts_stats_process(uint16_t keycode, const keyrecord_t *record) {
+    return keycode != LIGHTSHIFT_PRINT_STATS;
+}
+
+#endif
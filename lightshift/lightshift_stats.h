@@ -0,0 +1,151 @@
+/**
+ * lightshift_stats.h
+ * 
+ * Decision counters, for measuring the effect of tuning changes over days of
+ * real typing, without leaving (noisy, costly) debug output on.
+ * 
+ * Counts are cheap increments, printed to the console on demand (tap the
+ * LS_STAT key; tap with shift held to reset them).  With
+ * LIGHTSHIFT_STATS_PERSIST, they're also saved to EEPROM every so often, so
+ * they survive power cycles.
+ * 
+ * Enable with LIGHTSHIFT_STATS in config.h.
+ * 
+ */
+
+#pragma once
+#include "quantum.h"
+#include "lightshift_state.h"
+#include "lightshift_profiles.h"
+
+// time between saves, while counts are changing
+#ifndef LIGHTSHIFT_STATS_SAVE_INTERVAL
+    #define LIGHTSHIFT_STATS_SAVE_INTERVAL 600000 // 10 minutes
+#endif
+
+// location in the user EEPROM datablock (after any profiles or tuned terms)
+#ifndef LIGHTSHIFT_STATS_EEPROM_OFFSET
+    #ifdef LIGHTSHIFT_PROFILES
+        #define LIGHTSHIFT_STATS_EEPROM_OFFSET \
+            (LIGHTSHIFT_PROFILES_EEPROM_OFFSET + LIGHTSHIFT_PROFILES_SIZE)
+    #else
+        #define LIGHTSHIFT_STATS_EEPROM_OFFSET \
+            (LIGHTSHIFT_TUNING_EEPROM_OFFSET + LIGHTSHIFT_TERMS_SIZE)
+    #endif
+#endif
+
+#define LIGHTSHIFT_STATS_MAGIC 0x4C430001 // "LC", with streak taps
+
+/**
+ * @brief Convenience method for access to LIGHTSHIFT_STATS parameter
+ */
+inline bool lghts_stats(void) {
+    #ifdef LIGHTSHIFT_STATS
+        return true;
+    #else
+        return false;
+    #endif
+}
+
+
+/**
+ * @brief Lightshift decision counters
+ */
+typedef struct {
+    uint32_t magic;                                ///< ..._STATS_MAGIC
+    uint32_t transitions[LIGHTSHIFT_STATE_COUNT];  ///< entries to each state
+    uint32_t same_side;           ///< shifts resolved to the extended term
+    uint32_t opposite_side;       ///< shifts resolved to the lightshift term
+    uint32_t extended_expiries;   ///< extended terms expired (held => shift)
+    uint32_t dropshift_clears;    ///< double shifts cleared by dropshift
+    uint32_t overflows;           ///< presses beyond tracking capacity
+} lightshift_stats_t;
+
+// (a literal, for use in #if; checked against sizeof in lightshift_stats.c)
+#define LIGHTSHIFT_STATS_SIZE 56
+
+
+/**
+ * @brief Current counts
+ */
+const lightshift_stats_t* lightshift_get_stats(void);
+
+
+/**
+ * @brief Prints current counts to the console
+ */
+void lightshift_print_stats(void);
+
+
+/**
+ * @brief Zeroes all counts (and saved counts, if persisted)
+ */
+void lightshift_reset_stats(void);
+
+
+/**
+ * @brief Loads saved counts
+ * 
+ * By default, reads the EEPROM user datablock (with LIGHTSHIFT_STATS_PERSIST,
+ * if EECONFIG_USER_DATA_SIZE is large enough).  Override to store the counts
+ * elsewhere.
+ * 
+ * @return true if counts were loaded
+ */
+bool lightshift_load_stats(lightshift_stats_t *stats);
+
+
+/**
+ * @brief Saves counts; override to store the counts elsewhere
+ */
+void lightshift_save_stats(const lightshift_stats_t *stats);
+
+
+// Counters: callers test lghts_stats() first, so they compile away when off
+
+/**
+ * @brief Count a shift moving into state (SHIFT_INACTIVE: stopped tracking)
+ */
+void lghts_stats_transition(lightshift_state_t state);
+
+/**
+ * @brief Count a shift's term decision
+ */
+void lghts_stats_resolution(bool same_side);
+
+/**
+ * @brief Count an extended term expiring
+ */
+void lghts_stats_extended_expiry(void);
+
+/**
+ * @brief Count a double shift cleared by dropshift
+ */
+void lghts_stats_dropshift_clear(void);
+
+/**
+ * @brief Count a shift press which couldn't be tracked
+ */
+void lghts_stats_overflow(void);
+
+
+/**
+ * @brief Loads saved counts; call from keyboard_post_init
+ */
+void lghts_stats_init(void);
+
+
+/**
+ * @brief Saves changed counts every LIGHTSHIFT_STATS_SAVE_INTERVAL; call
+ *        from housekeeping_task
+ */
+void lghts_stats_task(void);
+
+
+/**
+ * @brief Prints (or, shifted, resets) counts on LS_STAT; call from
+ *        process_record
+ * 
+ * @return false if the key was LS_STAT (no further processing needed)
+ */
+bool lghts_stats_process(uint16_t keycode, const keyrecord_t *record);
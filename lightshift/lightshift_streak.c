@@ -0,0 +1,71 @@
+#include "lightshift_streak.h"
+#include "lightshift_drop.h"
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// State
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// letters pressed in the current streak (saturating), and when the last key
+// was pressed
+static uint8_t streak_keys = 0;
+static uint16_t last_press_time = 0;
+
+// does the key just pressed continue a streak?
+static bool in_streak = false;
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Interface
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Is this a letter (or a mod-tap / layer-tap with a letter to tap)?
+static bool is_letter(uint16_t keycode) {
+    if (IS_QK_MOD_TAP(keycode)) {
+        keycode = QK_MOD_TAP_GET_TAP_KEYCODE(keycode);
+    }
+    else if (IS_QK_LAYER_TAP(keycode)) {
+        keycode = QK_LAYER_TAP_GET_TAP_KEYCODE(keycode);
+    }
+    return keycode >= KC_A && keycode <= KC_Z;
+}
+
+
+// Update the streak from a key press: a letter soon enough after the last
+// key continues it; anything else ends it
+void lghts_streak_update(uint16_t keycode, const keyrecord_t *record) {
+    if (!lghts_streak() || !record->event.pressed) return;
+
+    uint16_t time = record->event.time;
+    uint16_t interval = TIMER_DIFF_16(time, last_press_time);
+    last_press_time = time;
+
+    // non-letters (e.g. Space) and shortcuts end the streak
+    if (!is_letter(keycode) || lghts_non_shift_mods_active()) {
+        streak_keys = 0;
+        in_streak = false;
+        return;
+    }
+
+    // as does a pause
+    if (interval >= LIGHTSHIFT_STREAK_TERM) streak_keys = 0;
+    in_streak = streak_keys >= LIGHTSHIFT_STREAK_MIN_KEYS;
+    if (streak_keys < UINT8_MAX) streak_keys++;
+}
+
+
+bool lghts_in_streak(void) {
+    return lghts_streak() && in_streak;
+}
+
+
+void lghts_streak_tap(keyrecord_t *record, uint16_t keycode) {
+    #ifdef LIGHTSHIFT_STREAK
+        // (with COMBO_ENABLE, QMK's tap-hold engine and processing both take
+        //  record->keycode, when set, instead of the keymap's)
+        record->keycode = QK_MOD_TAP_GET_TAP_KEYCODE(keycode);
+    #endif
+}
@@ -0,0 +1,81 @@
+/**
+ * lightshift_streak.h
+ *
+ * Typing streaks: mid-word, during fast typing, a hold is almost never
+ * intended, so a lightshift pressed in a streak is a tap straight away.  It
+ * skips the tap-hold decision (and its wait) altogether.
+ *
+ * A streak is a run of letter presses, each within LIGHTSHIFT_STREAK_TERM of
+ * the last.  A lightshift is tapped at once if it continues a streak of at
+ * least LIGHTSHIFT_STREAK_MIN_KEYS letters.  Anything other than a letter
+ * (e.g. Space, so a capital at the start of a word still shifts), a pause,
+ * or a held non-shift mod ends the streak.
+ *
+ * Enable with LIGHTSHIFT_STREAK in config.h.  The key's press and release
+ * are rewritten to its tap keycode, which QMK's tap-hold engine only reads
+ * (in place of the keymap's) with COMBO_ENABLE: enable it in rules.mk.
+ * REPEAT_KEY_ENABLE alone isn't enough, as the key is still buffered as a
+ * mod-tap.
+ *
+ */
+
+#pragma once
+#include "quantum.h"
+
+// longest time (ms) between letter presses in a streak
+#ifndef LIGHTSHIFT_STREAK_TERM
+    #define LIGHTSHIFT_STREAK_TERM 100
+#endif
+
+// letters in a row (each within the streak term) before a streak starts
+#ifndef LIGHTSHIFT_STREAK_MIN_KEYS
+    #define LIGHTSHIFT_STREAK_MIN_KEYS 2
+#endif
+
+#if defined(LIGHTSHIFT_STREAK) && !defined(COMBO_ENABLE)
+    #error "LIGHTSHIFT_STREAK needs COMBO_ENABLE"
+#endif
+#if LIGHTSHIFT_STREAK_MIN_KEYS > 255
+    #error "LIGHTSHIFT_STREAK_MIN_KEYS must be no more than 255"
+#endif
+
+/**
+ * @brief Convenience method for access to LIGHTSHIFT_STREAK parameter
+ */
+inline bool lghts_streak(void) {
+    #ifdef LIGHTSHIFT_STREAK
+        return true;
+    #else
+        return false;
+    #endif
+}
+
+
+/**
+ * @brief Follows the current streak of letters
+ *
+ * Call from pre_process_record on every key event, before tracking.  O(1).
+ *
+ * @param keycode Keycode assigned to the key event by QMK
+ * @param record Record for the key event
+ */
+void lghts_streak_update(uint16_t keycode, const keyrecord_t *record);
+
+
+/**
+ * @brief Does the key just pressed continue a streak?
+ *
+ * @return true if a lightshift pressed now should be tapped at once
+ */
+bool lghts_in_streak(void);
+
+
+/**
+ * @brief Rewrites a lightshift's key event as its tap keycode
+ *
+ * Set on both press and release, so QMK's tap-hold engine sees a plain key.
+ *
+ * @param record Record for the key event
+ * @param keycode Keycode of the lightshift
+ */
+void lghts_streak_tap(keyrecord_t *record, uint16_t keycode);
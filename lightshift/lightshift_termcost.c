@@ -0,0 +1,162 @@
+#include "lightshift_termcost.h"
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Cycle Counter
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__) \
+    || defined(__ARM_ARCH_8M_MAIN__)
+
+    // (addresses from the ARMv7-M / ARMv8-M architecture reference manuals)
+    #define DEMCR        (*(volatile uint32_t *)0xE000EDFC)
+    #define DEMCR_TRCENA (1u << 24)
+    #define DWT_CTRL     (*(volatile uint32_t *)0xE0001000)
+    #define DWT_CYCCNT   (*(volatile uint32_t *)0xE0001004)
+    #define DWT_LAR      (*(volatile uint32_t *)0xE0001FB0)
+    #define DWT_CYCCNTENA 1u
+
+    // (only enables the counter, leaving its count alone, as other code may
+    //  be timing with it: calls are timed by differences, so wrapping is fine)
+    static inline void start_cycle_counter(void) {
+        DEMCR |= DEMCR_TRCENA;
+        DWT_LAR = 0xC5ACCE55; // unlock, where required (e.g. Cortex-M7)
+        DWT_CTRL |= DWT_CYCCNTENA;
+    }
+
+    __attribute__((weak)) uint32_t lightshift_read_cycles(void) {
+        return DWT_CYCCNT;
+    }
+
+#else // no cycle counter: count calls only
+
+    static inline void start_cycle_counter(void) {}
+
+    __attribute__((weak)) uint32_t lightshift_read_cycles(void) {
+        return 0;
+    }
+
+#endif
+
+
+#ifdef LIGHTSHIFT_TERM_COSTS
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// State
+//
+///////////////////////////////////////////////////////////////////////////////
+
+static lightshift_term_costs_t costs = {0};
+
+// calls so far in this scan, and since the last key press
+static uint16_t scan_calls = 0;
+static uint16_t press_calls = 0;
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Measurements
+//
+///////////////////////////////////////////////////////////////////////////////
+
+static void add_sample(lightshift_range_t *range, uint32_t sample) {
+    if (!range->samples || sample < range->min) range->min = sample;
+    if (sample > range->max) range->max = sample;
+    range->total = sample > UINT32_MAX - range->total ? UINT32_MAX
+                                                      : range->total + sample;
+    range->samples++;
+}
+
+
+void lghts_term_costs_init(void) {
+    start_cycle_counter();
+}
+
+
+void lghts_term_costs_call(uint32_t cycles) {
+    add_sample(&costs.cycles_per_call, cycles);
+    if (scan_calls < UINT16_MAX) scan_calls++;
+    if (press_calls < UINT16_MAX) press_calls++;
+}
+
+
+// (scans with no undecided key make no calls, and aren't counted)
+void lghts_term_costs_task(void) {
+    if (!scan_calls) return;
+    add_sample(&costs.calls_per_scan, scan_calls);
+    scan_calls = 0;
+}
+
+
+void lghts_term_costs_event(const keyrecord_t *record) {
+    if (!record->event.pressed || !press_calls) return;
+    add_sample(&costs.calls_per_press, press_calls);
+    press_calls = 0;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Reporting
+//
+///////////////////////////////////////////////////////////////////////////////
+
+const lightshift_term_costs_t* lightshift_get_term_costs(void) {
+    return &costs;
+}
+
+
+// Prints min, avg (to 1 decimal place) and max, e.g. "1 / 2.5 / 7 (40)"
+static void print_range(const char *name, const lightshift_range_t *range) {
+    uint32_t avg_x10 = range->samples
+                       ? (uint32_t)((uint64_t)range->total * 10
+                                    / range->samples) : 0;
+    xprintf("  %-16s %lu / %lu.%lu / %lu (%lu)\n", name,
+            (unsigned long)range->min, (unsigned long)(avg_x10 / 10),
+            (unsigned long)(avg_x10 % 10), (unsigned long)range->max,
+            (unsigned long)range->samples);
+}
+
+
+void lightshift_print_term_costs(void) {
+    xprintf("LIGHTSHIFT TERM COSTS (min / avg / max (samples))\n");
+    print_range("Calls per scan:", &costs.calls_per_scan);
+    print_range("Calls per press:", &costs.calls_per_press);
+    if (costs.cycles_per_call.max) {
+        print_range("Cycles per call:", &costs.cycles_per_call);
+    }
+    else {
+        xprintf("  Cycles per call: not counted\n");
+    }
+}
+
+
+void lightshift_reset_term_costs(void) {
+    memset(&costs, 0, sizeof(costs));
+    scan_calls = 0;
+    press_calls = 0;
+}
+
+
+void lghts_term_costs_process(uint16_t keycode, const keyrecord_t *record) {
+    if (keycode != LIGHTSHIFT_PRINT_STATS || !record->event.pressed) return;
+    if ((get_mods() | get_oneshot_mods()) & MOD_MASK_SHIFT) {
+        lightshift_reset_term_costs();
+        xprintf("LIGHTSHIFT TERM COSTS reset\n");
+    }
+    else {
+        lightshift_print_term_costs();
+    }
+}
+
+#else
+
+void lghts_term_costs_init(void) {}
+void lghts_term_costs_call(uint32_t cycles) {}
+void lghts_term_costs_task(void) {}
+void lghts_term_costs_event(const keyrecord_t *record) {}
+void lghts_term_costs_process(uint16_t keycode, const keyrecord_t *record) {}
+
+#endif
@@ -0,0 +1,113 @@
+/**
+ * lightshift_termcost.h
+ *
+ * Tapping term instrumentation: how often QMK asks for a lightshift tapping
+ * term, and what each answer costs.  QMK calls get_tapping_term() on every
+ * scan while a key is undecided, so this is where the term logic's cost
+ * adds up.
+ *
+ * Counts get_lightshift_term() calls per scan (of scans with any calls) and
+ * per key press (calls from one press to the next, where there are any), and
+ * the CPU cycles each call takes.  Each is kept as min / avg / max, printed
+ * to the console on demand (tap the LS_STAT key; tap with shift held to
+ * reset them).
+ *
+ * Cycles are read from the DWT cycle counter on Cortex-M3 / M4 / M7 / M33.
+ * Elsewhere (e.g. AVR, RP2040), only calls are counted, unless you provide
+ * your own lightshift_read_cycles().
+ *
+ * Enable with LIGHTSHIFT_TERM_COSTS in config.h.
+ *
+ */
+
+#pragma once
+#include "quantum.h"
+
+/**
+ * @brief Convenience method for access to LIGHTSHIFT_TERM_COSTS parameter
+ */
+inline bool lghts_term_costs(void) {
+    #ifdef LIGHTSHIFT_TERM_COSTS
+        return true;
+    #else
+        return false;
+    #endif
+}
+
+
+/**
+ * @brief Smallest, total and largest of a series of samples
+ */
+typedef struct {
+    uint32_t min;
+    uint32_t max;
+    uint32_t total;       ///< sum of samples (saturating)
+    uint32_t samples;
+} lightshift_range_t;
+
+
+/**
+ * @brief Tapping term instrumentation, since power on or the last reset
+ */
+typedef struct {
+    lightshift_range_t calls_per_scan;
+    lightshift_range_t calls_per_press;
+    lightshift_range_t cycles_per_call;  ///< all 0 if cycles aren't counted
+} lightshift_term_costs_t;
+
+
+/**
+ * @brief Current measurements
+ */
+const lightshift_term_costs_t* lightshift_get_term_costs(void);
+
+
+/**
+ * @brief Prints current measurements to the console
+ */
+void lightshift_print_term_costs(void);
+
+
+/**
+ * @brief Zeroes all measurements
+ */
+void lightshift_reset_term_costs(void);
+
+
+/**
+ * @brief Reads a free-running CPU cycle counter
+ *
+ * By default, the DWT cycle counter on ARMv7-M / ARMv8-M Mainline, or 0
+ * where there is none.  Override to use another counter.
+ */
+uint32_t lightshift_read_cycles(void);
+
+
+// Hooks: callers test lghts_term_costs() first, so they compile away when off
+
+/**
+ * @brief Starts the cycle counter; call from keyboard_post_init
+ */
+void lghts_term_costs_init(void);
+
+/**
+ * @brief Counts a get_lightshift_term() call, taking cycles
+ */
+void lghts_term_costs_call(uint32_t cycles);
+
+/**
+ * @brief Ends a scan's count; call from housekeeping_task
+ */
+void lghts_term_costs_task(void);
+
+/**
+ * @brief Ends a key press's count; call from pre_process_record
+ */
+void lghts_term_costs_event(const keyrecord_t *record);
+
+/**
+ * @brief Prints (or, with shift held, resets) measurements on LS_STAT
+ *
+ * Leaves the key to lghts_stats_process(), which handles it after.
+ */
+void lghts_term_costs_process(uint16_t keycode, const keyrecord_t *record);
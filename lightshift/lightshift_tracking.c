@@ -2,77 +2,15 @@
 #include "lightshift_tracking.h"
 #include "lightshift_debug.h"
 #include "lightshift_drop.h"
+#include "lightshift_tuning.h"
+#include "lightshift_bigram.h"
+#include "lightshift_stats.h"
+#include "lightshift_fsm.h"
+#include "lightshift_keyclass.h"
+#include "lightshift_streak.h"
 
-///////////////////////////////////////////////////////////////////////////////
-//
-// State Machine
-//
-///////////////////////////////////////////////////////////////////////////////
-
-/**
-*     
-*                                  ┌─────────────────┐
-*                                  │     INACTIVE    │
-*                                  └────────┬────────┘
-*                                           │
-*                                      [pp] shift
-*                                        pressed
-*                                           │
-*                                           v      
-*                                  ┌─────────────────┐
-*          ┌───────────────────────│    UNRESOLVED   │─────────────────┐
-*          │                       └────────┬────────┘                 │
-*          │                                │                          │
-*          │                    ┌───────────┴───────────┐              │
-*          │                    │                       │              │
-*       tapping          [pp] opp-side           [pp] same-side    [pp] shift
-*        term                  key                     key          released
-*          │                    │                       │            (=tap)
-*          │                    v                       v              │
-*          │         ┌─────────────────────┐    ┌───────────────┐      │
-*          │         │    LIGHTSHIFT TT    │    │  EXTENDED TT  │      │
-*          │         └───┬─────────────┬───┘    └───────┬───────┘      │
-*          │             │             │                │              │
-*          │          tapping     [pp] shift       [pp] shift          │
-*          │           term        released         released           │
-*          │             │          (=tap)           (=tap)            │
-*          │             │             │                │              │
-*          │             │             │                │              │
-*          v             v             │                v              │
-*    ┌────────────────────────────┐    │        ┌───────────────┐      │
-*    │      SINGLE SHIFTING       │    │        │   RELEASED,   │      │
-*    └─────┬─────────────┬────────┘    │        │   EXTENDED    │      │
-*          │             │             │        └───────┬───────┘      │
-*      consuming         └─── shift ───┐                │              │
-*      shiftable             released  │                │              │
-*      keypress                        │                │              │
-*          │                           │                │              │
-*          v                           │                │              │
-*    ┌────────────────────────────┐    │                │              │
-*    │      DOUBLE SHIFTING       │    │                │              │
-*    └──────┬────────────┬────────┘    │                │              │
-*           │            │             │                │              │
-*      disallowed        └─── shift ───┐          [pp] any next        │
-*       shiftable            released  │            key event          │
-*       keypress                       │                │              │
-*           │                          │                │              │
-*           v                          v                v              v
-*    ┌─────────────────────────────────────────────────────────────────────┐
-*    │                            INACTIVE                                 │
-*    └─────────────────────────────────────────────────────────────────────┘
-*
-*    Transition Triggers:
-*    --------------------
-*    [pp]   => pre_process_record  (for Extended Tapping Term)
-*    others => process_record      (for Dropshift)
-*
-* 
-*    NB: EXTENDED_TT -> SINGLE_SHIFTING is also possible, should the
-*        Extended Tapping Term expire. The default ETT of 65,535ms renders
-*        this impossible in real-world use, but shorter, custom ETTs may
-*        allow for it.
-* 
-*/
+// State transitions are defined in lightshift_fsm.c: tracking code here
+// classifies key events, and fires them at the shifts they concern
 
 ///////////////////////////////////////////////////////////////////////////////
 //
@@ -83,7 +21,7 @@
 // Is this a layer / modifier key (excluding MT / LT keys)?
 // For use in pre_process_record, where MT / LT keys are not yet resolved
 bool is_layer_or_mod_ppr(uint16_t keycode) {
-    return IS_MODIFIER_KEYCODE(keycode) // KC_LEFT_CTRL to KC_RIGHT_GUI
+    return lghts_key_is(keycode, LGHTS_KEY_LAYER_OR_MOD) // modifier keys
            || (keycode >= QK_LAYER_MOD
                && keycode <= QK_PERSISTENT_DEF_LAYER_MAX) // layers & OSM
            || (keycode == QK_LAYER_LOCK); // layer lock
@@ -157,6 +95,50 @@ bool lghts_is_layer_or_mod(uint16_t keycode, const keyrecord_t *record) {
 #endif
 
 
+// Handedness is resolved once at init into a packed map of 2-bit codes, so
+// the hot path needs no user callbacks or PROGMEM reads
+#define HAND_UNKNOWN 0 // not yet resolved, or unusual: ask live
+#define HAND_LEFT    1
+#define HAND_RIGHT   2
+#define HAND_EITHER  3 // '*', e.g. thumb keys
+
+#define HAND_POSITIONS (MATRIX_ROWS * MATRIX_COLS)
+static uint8_t hand_map[(HAND_POSITIONS + 3) / 4] = {0};
+
+static const char hand_chars[] = {0, 'L', 'R', '*'};
+
+
+// Resolve handedness for every matrix position into hand_map
+void lghts_init_handedness(void) {
+    memset(hand_map, 0, sizeof(hand_map));
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            keypos_t key = {.col = col, .row = row};
+            uint8_t code;
+            switch (lightshift_handedness(key)) {
+                case 'L': code = HAND_LEFT;   break;
+                case 'R': code = HAND_RIGHT;  break;
+                case '*': code = HAND_EITHER; break;
+                default:  code = HAND_UNKNOWN; break;
+            }
+            uint16_t i = row * MATRIX_COLS + col;
+            hand_map[i >> 2] |= code << ((i & 3) * 2);
+        }
+    }
+}
+
+
+// Handedness from hand_map (off-matrix keys, e.g. combos, are asked live)
+char lightshift_cached_handedness(keypos_t key) {
+    if (key.row < MATRIX_ROWS && key.col < MATRIX_COLS) {
+        uint16_t i = key.row * MATRIX_COLS + key.col;
+        uint8_t code = (hand_map[i >> 2] >> ((i & 3) * 2)) & 0x03;
+        if (code != HAND_UNKNOWN) return hand_chars[code];
+    }
+    return lightshift_handedness(key);
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////
 //
 // Extended Tapping Term
@@ -164,94 +146,101 @@ bool lghts_is_layer_or_mod(uint16_t keycode, const keyrecord_t *record) {
 ///////////////////////////////////////////////////////////////////////////////
 
 // Update State: Lightshift pressed
-static void track_new_shift(const keyrecord_t *record) {
-    // newly pressed lightshifts => UNRESOLVED
-    lghts_set_state(record->event.key, SHIFT_UNRESOLVED);
+static void track_new_shift(uint16_t keycode, keyrecord_t *record) {
+    // newly pressed lightshifts => UNRESOLVED (or STREAK TAP, mid-streak)
+    // (LGHTS_EV_SHIFT_PRESSED: an untracked shift needs a slot first)
+    bool streak = lghts_streak() && lghts_in_streak();
+    lightshift_state_t state = SHIFT_INACTIVE;
+    lghts_fsm_lookup(SHIFT_INACTIVE, streak ? LGHTS_EV_STREAK_PRESSED
+                                            : LGHTS_EV_SHIFT_PRESSED, &state);
+    uint8_t slot = lghts_start_tracking(record->event.key, keycode, state);
+
+    // a streak tap is its tap keycode from the start (if there's no slot to
+    // remember it by until release, it stays a mod-tap)
+    if (streak && slot != LGHTS_NO_SLOT) lghts_streak_tap(record, keycode);
 }
 
 
 // Update State: Decide Tapping Term
-// - if an UNRESOLVED lightshift was pressed before this key, update its
-//   status based on whether this is a same or opposite side key
-static void decide_tapping_term(uint16_t keycode, const keyrecord_t *record) {
-
-    // leave lightshifts UNRESOLVED if
-    if ((!record->event.pressed) // key released, not pressed
-        || is_layer_or_mod_ppr(keycode)) // key is (non-MT/LT) layer or mod key
-    {
+// - an UNRESOLVED lightshift was pressed before this key: update its status
+//   based on whether this is a same or opposite side key
+static void decide_tapping_term(uint8_t slot, char hand,
+                                const keyrecord_t *record) {
+    bool same_hand = hand == lightshift_cached_handedness(lghts_slot_key(slot));
+    if (lghts_fire_slot(slot, same_hand ? LGHTS_EV_SAME_SIDE_KEY
+                                        : LGHTS_EV_OPP_SIDE_KEY)
+            != LGHTS_ACT_TERM_DECIDED) {
         return;
     }
-    
-    // otherwise, resolve any UNRESOLVEDs
-    for (uint8_t i = 0; i < num_active_lghts(); i++) {
-        shift_t shift = get_lghts(i);
-        if (shift.state == SHIFT_UNRESOLVED) {
-            bool same_hand = lightshift_handedness(record->event.key)
-                           == lightshift_handedness(shift.key);
-            lghts_set_state(shift.key, same_hand ?
-                            SHIFT_EXTENDED_TT : SHIFT_LIGHTSHIFT_TT);
-        }
+    if (lghts_stats()) lghts_stats_resolution(same_hand);
+    // other mods: no letter context, and no shift state to watch
+    if (!(lghts_class_slots(LGHTS_CLASS_SHIFT) & (1 << slot))) return;
+    // adjust the chosen term for context, e.g. a fast "st" roll
+    if (lghts_bigrams()) {
+        lghts_set_slot_term_adjust(slot,
+                                   lghts_bigram_adjust(
+                                       lghts_slot_keycode(slot), same_hand));
     }
-}
-
-
-// Update State: Non-held lightshift released
-static void release_non_held_shift(const keyrecord_t *record) {
-    keypos_t key = record->event.key;
-    switch (lghts_get_state(key)) {
-
-            // released EXTENDED TTs => RELEASED EXTENDED
-            // (we need to retain the correct TT in state, as QMK doesn't
-            //  decide mod-taps until later in the processing cycle)
-            case SHIFT_EXTENDED_TT:
-                lghts_set_state(key, SHIFT_RELEASED_EXTENDED);
-                break;
-
-            // other non-held releases: set INACTIVE
-            case SHIFT_UNRESOLVED:
-            case SHIFT_LIGHTSHIFT_TT:
-                lghts_set_state(key, SHIFT_INACTIVE);
-                break;
-
-            default:
-                break;
-        }
-}
-
-
-// Update State: Stop tracking any outstanding RELEASED EXTENDEDs
-static void update_expired_states(void) {
-    for (uint8_t i = 0; i < num_active_lghts(); i++) {
-        shift_t shift = get_lghts(i);
-        if (shift.state == SHIFT_RELEASED_EXTENDED) {
-            lghts_set_state(shift.key, SHIFT_INACTIVE);
-        }
+    // this key's shift state is now down to the chosen term (the shift's
+    // keycode is a keymap lookup, so only made when tuning)
+    if (lghts_tuning()) {
+        lghts_tuning_note_decision(record->event.key, same_hand,
+                                   lghts_slot_keycode(slot));
     }
 }
 
 
 // Extended TT: Hook from pre_process_record()
 // Updates: new shift presses; handedness decisions; releasing non-held shifts
-void lghts_track_ppr(uint16_t keycode, const keyrecord_t *record) {
-    keypos_t key = record->event.key;
-
-    // RELEASED EXTENDED => INACTIVE
-    update_expired_states();
-
-    // UNRESOLVED => INACTIVE, LIGHTSHIFT TT => INACTIVE,
-    // EXTENDED TT => RELEASED EXTENDED
-    if (!record->event.pressed && is_tracked_lghts(key)) {
-        // QMK Non-held lightshifts: Tracking ceases here (in
-        // pre_process_record) to ensure ceasation when used in combos, etc.
-        release_non_held_shift(record);
+// (one pass visits each tracked shift once, applying whichever transition
+//  this event brings it)
+void lghts_track_ppr(uint16_t keycode, keyrecord_t *record) {
+    bool pressed = record->event.pressed;
+
+    // the slot of this key, if it's a tracked shift being released
+    uint8_t released = pressed ? LGHTS_NO_SLOT
+                               : lghts_find_slot(record->event.key);
+
+    // resolve UNRESOLVEDs on any press, except of a (non-MT/LT) layer or mod
+    // key
+    bool resolving = pressed && lghts_slots_in_state(SHIFT_UNRESOLVED)
+                             && !is_layer_or_mod_ppr(keycode);
+    char hand = resolving ? lightshift_cached_handedness(record->event.key)
+                          : 0;
+
+    uint8_t slots = lghts_active_slots();
+    for (uint8_t i = 0; slots; i++, slots >>= 1) {
+        lghts_probe_iteration();
+        if (!(slots & 1)) continue;
+        lightshift_state_t state = lghts_slot_state(i);
+
+        // RELEASED EXTENDED => INACTIVE (on any event after the release)
+        if (state == SHIFT_RELEASED_EXTENDED) {
+            lghts_fire_slot(i, LGHTS_EV_NEXT_KEY);
+        }
+        // UNRESOLVED => INACTIVE, LIGHTSHIFT TT => INACTIVE,
+        // EXTENDED TT => RELEASED EXTENDED
+        // (QMK Non-held lightshifts: Tracking ceases here, in
+        //  pre_process_record, to ensure ceasation when used in combos, etc.
+        //  No need to resolve rolls early: QMK already decides a tap as soon
+        //  as the key is released within its term, and flushes any buffered
+        //  keys straight after it)
+        else if (i == released) {
+            // STREAK TAP => INACTIVE: released as the key it tapped
+            if (state == SHIFT_STREAK_TAP) {
+                lghts_streak_tap(record, lghts_slot_keycode(i));
+            }
+            lghts_fire_slot(i, LGHTS_EV_TAP_RELEASED);
+        }
+        // UNRESOLVED => LIGHTSHIFT TT, UNRESOLVED => EXTENDED TT
+        else if (resolving && state == SHIFT_UNRESOLVED) {
+            decide_tapping_term(i, hand, record);
+        }
     }
 
-    // UNRESOLVED => LIGHTSHIFT TT, UNRESOLVED => EXTENDED TT
-    decide_tapping_term(keycode, record);
-
     // INACTIVE => UNRESOLVED
-    if (record->event.pressed && is_lightshift(keycode)) {
-        track_new_shift(record);
+    if (pressed && is_lightshift_mod(keycode)) {
+        track_new_shift(keycode, record);
     }
 }
 
@@ -266,94 +255,69 @@ void lghts_track_ppr(uint16_t keycode, const keyrecord_t *record) {
 // its keycode
 // DOUBLE SHIFTING => INACTIVE (2 of 2)
 uint16_t lghts_set_double_inactive(uint16_t keycode) {
-    for (uint8_t i = 0; i < num_active_lghts(); i++) {
-        shift_t shift = get_lghts(i);
-        if (shift.state == SHIFT_DOUBLE_SHIFTING) {
+    uint8_t slots = lghts_slots_in_state(SHIFT_DOUBLE_SHIFTING);
+    for (uint8_t i = 0; slots; i++, slots >>= 1) {
+        lghts_probe_iteration();
+        if (slots & 1) {
+            uint16_t shift_keycode = lghts_slot_keycode(i);
             // set state to INACTIVE (= stop tracking)
             lghts_dprintf("Shift dropped by disallowed %s double",
                           get_keycode_string(keycode));
-            lghts_set_state(shift.key, SHIFT_INACTIVE);
-            return shift.keycode;
+            lghts_fire_slot(i, LGHTS_EV_DISALLOWED);
+            return shift_keycode;
         }
     }
     return KC_NO;
 }
 
 
-// Update State: Held lightshift released
-static void release_held_shift(const keyrecord_t *record) {
-    // Released shift => SHIFT_INACTIVE
-    keypos_t key = record->event.key;
-    switch (lghts_get_state(key)) {
-            case SHIFT_SINGLE_SHIFTING:
-            case SHIFT_DOUBLE_SHIFTING:
-                lghts_set_state(key, SHIFT_INACTIVE);
-                break;
-            default:
-                break;
-        }
-}
-
-
 // Update State: Consume single shifts, if this keypress was shifted by them
 static void consume_single_shifts(uint16_t keycode,
                                   const keyrecord_t *record) {
     // don't mark shift as used if...
-    if (!record->event.pressed // release rather than press
+    uint8_t slots = lghts_slots_in_state(SHIFT_SINGLE_SHIFTING)
+                    & lghts_class_slots(LGHTS_CLASS_SHIFT); // (only shifts)
+    if (!slots // no single shifts to consume
+        || !record->event.pressed // release rather than press
         || lghts_is_layer_or_mod(keycode, record) // layer switch or mod
         || !lightshift_consume_single(keycode, record)) { // should not consume
             return;
     }
 
     // future shift uses are now doubles
-    for (uint8_t i = 0; i < num_active_lghts(); i++) {
-        shift_t shift = get_lghts(i);
-        if (shift.state == SHIFT_SINGLE_SHIFTING) {
-                lghts_dprintf("Single consumed by %s",
-                              get_keycode_string(keycode));
-                lghts_set_state(shift.key, SHIFT_DOUBLE_SHIFTING);
-        }
-    }
-}
-
-
-// Update State: Tapping term expired
-static void handle_tapping_term_expiries(uint16_t keycode,
-                                         const keyrecord_t *record) {
-    // if a pressed and held lightshift (i.e. tapping_term just expired)
-    if (is_lightshift(keycode) && record->event.pressed
-                               && !record->tap.count) {
-        keypos_t key = record->event.key;
-        switch (lghts_get_state(key)) {
-            case SHIFT_UNRESOLVED:
-            case SHIFT_LIGHTSHIFT_TT:
-            case SHIFT_EXTENDED_TT: // include Extended for short, custom ETTs
-                lghts_set_state(key, SHIFT_SINGLE_SHIFTING);
-                break;
-            default:
-                break;
-        }
+    lghts_dprintf("Single consumed by %s", get_keycode_string(keycode));
+    for (uint8_t i = 0; slots; i++, slots >>= 1) {
+        lghts_probe_iteration();
+        if (slots & 1) lghts_fire_slot(i, LGHTS_EV_CONSUMED);
     }
 }
 
 
 // Dropshift: Hook from process_record()
 // Update: tapping_term expiries; consuming singles; releasing held shifts
+// (each event brings at most one of these, so only the one concerned runs)
 void lghts_track_pr(uint16_t keycode, const keyrecord_t *record) {
-    keypos_t key = record->event.key;
 
     // SINGLE SHIFTING => INACTIVE, DOUBLE SHIFTING => INACTIVE (1 of 2)
-    if (!record->event.pressed && is_tracked_lghts(key))
-    {
-        // QMK Held lightshifts: Tracking ceases here (in process_record)
-        // to ensure all potentially shifted keys are processed before
-        // tracking ends (pre-process record is too early)
-        release_held_shift(record);
+    // (QMK Held lightshifts: Tracking ceases here, in process_record, to
+    //  ensure all potentially shifted keys are processed before tracking
+    //  ends - pre-process record is too early)
+    if (!record->event.pressed) {
+        lghts_fire(record->event.key, LGHTS_EV_HOLD_RELEASED);
+        return;
+    }
+
+    // UNRESOLVED => SINGLE SHIFTING, LIGHTSHIFT TT => SINGLE SHIFTING
+    // (a pressed and held lightshift, i.e. its tapping term just expired;
+    //  being a held MT, it never consumes a single)
+    if (is_lightshift_mod(keycode) && !record->tap.count) {
+        if (lghts_fire(record->event.key, LGHTS_EV_TERM_EXPIRED)
+                == LGHTS_ACT_EXTENDED_EXPIRED && lghts_stats()) {
+            lghts_stats_extended_expiry();
+        }
+        return;
     }
 
     // SINGLE SHIFTING => DOUBLE SHIFTING
     consume_single_shifts(keycode, record);
-
-    // UNRESOLVED => SINGLE SHIFTING, LIGHTSHIFT TT => SINGLE SHIFTING
-    handle_tapping_term_expiries(keycode, record);
 }
@@ -15,7 +15,7 @@
  * @param keycode Keycode assigned to the key event by QMK
  * @param record Record for the key event
  */
-void lghts_track_ppr(uint16_t keycode, const keyrecord_t *record);
+void lghts_track_ppr(uint16_t keycode, keyrecord_t *record);
 
 
 /**
@@ -42,6 +42,19 @@ void lghts_track_pr(uint16_t keycode, const keyrecord_t *record);
 uint16_t lghts_set_double_inactive(uint16_t keycode);
 
 
+/**
+ * @brief Checks if given keycode is a layer switch or modifier, excluding
+ *        MT / LT keys
+ * 
+ * For use in pre_process_record, where MT / LT keys are not yet resolved
+ * 
+ * @param keycode Keycode to be checked
+ * 
+ * @return true if (non-MT/LT) layer switch or modifier, false if not
+ */
+bool is_layer_or_mod_ppr(uint16_t keycode);
+
+
 /**
  * @brief Checks if given keycode and record are a layer switch or modifier
  * 
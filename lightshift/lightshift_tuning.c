@@ -0,0 +1,269 @@
+#include "lightshift.h"
+#include "lightshift_tuning.h"
+#include "lightshift_debug.h"
+
+_Static_assert(sizeof(lightshift_terms_t) == LIGHTSHIFT_TERMS_SIZE,
+               "lightshift_terms_t must match LIGHTSHIFT_TERMS_SIZE");
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// State
+//
+///////////////////////////////////////////////////////////////////////////////
+
+static uint16_t tuned_term = LIGHTSHIFT_TAPPING_TERM;
+static uint16_t tuned_extended_term = LIGHTSHIFT_EXTENDED_TAPPING_TERM;
+
+// tuned terms awaiting save
+static bool dirty = false;
+static uint32_t last_change = 0;
+
+// which tapping term decided the shift state of a letter?
+typedef enum {
+    SIDE_NONE,     // no decision: can't be attributed
+    SIDE_OPPOSITE, // lightshift tapping term
+    SIDE_SAME,     // extended tapping term
+} decision_side_t;
+
+// most recent tapping term decision, and the tap letter of its shift
+static keypos_t decision_key;
+static decision_side_t decision_side = SIDE_NONE;
+static uint16_t decision_shift_letter = KC_NO;
+
+// letter which may be about to be corrected
+static struct {
+    uint16_t letter;        // tap keycode, KC_A to KC_Z
+    bool shifted;           // was it shifted?
+    decision_side_t side;   // decision which (didn't) shift it
+    uint16_t shift_letter;  // tap keycode of the lightshift deciding it
+    bool shift_retyped;     // shift's own letter retyped since backspacing?
+    uint16_t time;          // when it was typed
+    uint8_t backspaces;     // backspaces since
+} candidate = {0};
+
+// backspaces allowed between letter & retyping (2 covers a missed shift,
+// which types the shift key's tap letter too, e.g. "si" for "I")
+#define MAX_BACKSPACES 2
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Persistence
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#if defined(EECONFIG_USER_DATA_SIZE) && EECONFIG_USER_DATA_SIZE \
+    >= LIGHTSHIFT_TUNING_EEPROM_OFFSET + LIGHTSHIFT_TERMS_SIZE
+
+    __attribute__((weak)) bool lightshift_load_terms(
+                                                lightshift_terms_t *terms) {
+        eeconfig_read_user_datablock(terms, LIGHTSHIFT_TUNING_EEPROM_OFFSET,
+                                     LIGHTSHIFT_TERMS_SIZE);
+        return terms->magic == LIGHTSHIFT_TERMS_MAGIC;
+    }
+
+    __attribute__((weak)) void lightshift_save_terms(
+                                          const lightshift_terms_t *terms) {
+        eeconfig_update_user_datablock(terms, LIGHTSHIFT_TUNING_EEPROM_OFFSET,
+                                       LIGHTSHIFT_TERMS_SIZE);
+    }
+
+#else // no EEPROM space: tuned terms last until power off
+
+    __attribute__((weak)) bool lightshift_load_terms(
+                                                lightshift_terms_t *terms) {
+        return false;
+    }
+
+    __attribute__((weak)) void lightshift_save_terms(
+                                          const lightshift_terms_t *terms) {}
+
+#endif
+
+
+// Keep a term within bounds
+static uint16_t bound(uint16_t term, uint16_t max_term) {
+    if (term < LIGHTSHIFT_TUNING_MIN_TERM) return LIGHTSHIFT_TUNING_MIN_TERM;
+    if (term > max_term) return max_term;
+    return term;
+}
+
+
+void lghts_tuning_init(void) {
+    if (!lghts_tuning()) return;
+
+    lightshift_terms_t terms;
+    if (lightshift_load_terms(&terms)) {
+        tuned_term = bound(terms.term, LIGHTSHIFT_TUNING_MAX_TERM);
+        // the extended term is only tuned if it's custom (i.e. expires)
+        if (LIGHTSHIFT_EXTENDED_TAPPING_TERM != UINT16_MAX) {
+            tuned_extended_term = bound(terms.extended_term,
+                                        LIGHTSHIFT_TUNING_MAX_EXTENDED_TERM);
+        }
+        lghts_dprintf("Tuned TTs loaded: %u, %u", tuned_term,
+                      tuned_extended_term);
+    }
+}
+
+
+void lghts_tuning_task(void) {
+    if (!dirty || timer_elapsed32(last_change) < LIGHTSHIFT_TUNING_SAVE_DELAY) {
+        return;
+    }
+    lightshift_terms_t terms = {LIGHTSHIFT_TERMS_MAGIC, tuned_term,
+                                tuned_extended_term};
+    lightshift_save_terms(&terms);
+    dirty = false;
+    lghts_dprintf("Tuned TTs saved: %u, %u", tuned_term, tuned_extended_term);
+}
+
+
+void lightshift_tuning_reset(void) {
+    tuned_term = LIGHTSHIFT_TAPPING_TERM;
+    tuned_extended_term = LIGHTSHIFT_EXTENDED_TAPPING_TERM;
+    dirty = true;
+    last_change = timer_read32();
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Terms
+//
+///////////////////////////////////////////////////////////////////////////////
+
+uint16_t lghts_tuned_term(void) {
+    return lghts_tuning() ? tuned_term : LIGHTSHIFT_TAPPING_TERM;
+}
+
+
+uint16_t lghts_tuned_extended_term(void) {
+    return lghts_tuning() ? tuned_extended_term
+                          : LIGHTSHIFT_EXTENDED_TAPPING_TERM;
+}
+
+
+// Nudge the term for the decision which misfired
+static void nudge(decision_side_t side, bool wrongly_shifted) {
+    bool same = side == SIDE_SAME;
+    uint16_t* term = same ? &tuned_extended_term : &tuned_term;
+
+    // an extended term which never expires has nothing to tune
+    if (*term == UINT16_MAX) return;
+
+    // shifted by mistake: held past the term, so lengthen it
+    // shift missed: released within the term, so shorten it
+    uint16_t nudged = wrongly_shifted ? *term + LIGHTSHIFT_TUNING_STEP
+                                      : *term - LIGHTSHIFT_TUNING_STEP;
+    nudged = bound(nudged, same ? LIGHTSHIFT_TUNING_MAX_EXTENDED_TERM
+                                : LIGHTSHIFT_TUNING_MAX_TERM);
+    if (nudged == *term) return;
+
+    lghts_dprintf("Misshift (%s, %s): TT %u -> %u",
+                  same ? "same side" : "opposite side",
+                  wrongly_shifted ? "unwanted shift" : "missed shift",
+                  *term, nudged);
+    *term = nudged;
+    dirty = true;
+    last_change = timer_read32();
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Detecting Corrections
+//
+///////////////////////////////////////////////////////////////////////////////
+
+void lghts_tuning_note_decision(keypos_t key, bool same_hand,
+                                uint16_t shift_keycode) {
+    if (!lghts_tuning()) return;
+    decision_key = key;
+    decision_side = same_hand ? SIDE_SAME : SIDE_OPPOSITE;
+    decision_shift_letter = QK_MOD_TAP_GET_TAP_KEYCODE(shift_keycode);
+}
+
+
+// Tap keycode of a basic key, or tapped MT / LT key
+static uint16_t tapped_keycode(uint16_t keycode, const keyrecord_t *record) {
+    if (IS_QK_MOD_TAP(keycode) || IS_QK_LAYER_TAP(keycode)) {
+        if (record->tap.count == 0) return KC_NO; // held
+        return IS_QK_MOD_TAP(keycode) ? QK_MOD_TAP_GET_TAP_KEYCODE(keycode)
+                                      : QK_LAYER_TAP_GET_TAP_KEYCODE(keycode);
+    }
+    return keycode;
+}
+
+
+// Watch for: letter, backspace(s), same letter with opposite shift state
+// (an unwanted shift swallowed the shift key's own letter, e.g. "st" => "T",
+//  so that's retyped first: "T", backspace, "s", "t")
+void lghts_tuning_process(uint16_t keycode, const keyrecord_t *record) {
+    if (!lghts_tuning() || !record->event.pressed) return;
+
+    uint16_t tapped = tapped_keycode(keycode, record);
+    bool in_window = TIMER_DIFF_16(record->event.time, candidate.time)
+                     <= LIGHTSHIFT_TUNING_WINDOW;
+
+    // backspace: may be correcting the candidate
+    if (tapped == KC_BSPC) {
+        if (candidate.side != SIDE_NONE && in_window
+                && candidate.backspaces < MAX_BACKSPACES) {
+            candidate.backspaces++;
+        }
+        else {
+            candidate.side = SIDE_NONE;
+        }
+        return;
+    }
+
+    // anything but a letter (or a held shift) ends the pattern
+    if (tapped < KC_A || tapped > KC_Z) {
+        if (tapped != KC_NO) candidate.side = SIDE_NONE;
+        return;
+    }
+
+    // shift state (caps word & caps lock make this ambiguous, so skip)
+    bool caps = host_keyboard_led_state().caps_lock;
+    #ifdef CAPS_WORD_ENABLE
+        caps = caps || is_caps_word_on();
+    #endif
+    if (caps) {
+        candidate.side = SIDE_NONE;
+        return;
+    }
+    bool shifted = (get_mods() | get_weak_mods()) & MOD_MASK_SHIFT;
+
+    bool correcting = candidate.side != SIDE_NONE && candidate.backspaces > 0
+                      && in_window;
+
+    // retyped with opposite shift state: a correction!
+    if (correcting && tapped == candidate.letter
+            && shifted != candidate.shifted) {
+        nudge(candidate.side, candidate.shifted);
+        candidate.side = SIDE_NONE;
+        return;
+    }
+
+    // shifted by mistake: the shift's own letter comes back first (once)
+    if (correcting && candidate.shifted && !candidate.shift_retyped
+            && tapped == candidate.shift_letter && !shifted) {
+        candidate.shift_retyped = true;
+        return;
+    }
+
+    // otherwise, this letter may be corrected next (if a tapping term
+    // decision was made by this key)
+    candidate.letter = tapped;
+    candidate.shifted = shifted;
+    candidate.time = record->event.time;
+    candidate.backspaces = 0;
+    candidate.side = SIDE_NONE;
+    candidate.shift_retyped = false;
+    if (decision_side != SIDE_NONE
+            && KEYEQ(decision_key, record->event.key)) {
+        candidate.side = decision_side;
+        candidate.shift_letter = decision_shift_letter;
+        decision_side = SIDE_NONE;
+    }
+}
@@ -0,0 +1,160 @@
+/**
+ * lightshift_tuning.h
+ * 
+ * Self-tuning adjusts the tapping terms from your own corrections.
+ * 
+ * The clearest sign of a misshift is its correction: a letter, then
+ * Backspace, then the same letter retyped with the opposite shift.  (An
+ * unwanted shift also swallows the shift key's own letter, so that may be
+ * retyped first: "st" => "T", Backspace, "s", "t".)  Lightshift
+ * notes which decision (same-side or opposite-side) shifted, or didn't shift,
+ * the original letter, and nudges that decision's tapping term:
+ * 
+ *     shifted by mistake   =>  term too short  =>  lengthen it
+ *     shift missed         =>  term too long   =>  shorten it
+ * 
+ * Tuned terms stay within configurable bounds, and are saved to EEPROM a
+ * little while after they last changed.
+ * 
+ * Enable with LIGHTSHIFT_TUNING in config.h.
+ * 
+ */
+
+#pragma once
+#include "quantum.h"
+
+#ifndef LIGHTSHIFT_TUNING_STEP
+    #define LIGHTSHIFT_TUNING_STEP 5 // ms per correction
+#endif
+
+#ifndef LIGHTSHIFT_TUNING_MIN_TERM
+    #define LIGHTSHIFT_TUNING_MIN_TERM 100
+#endif
+
+#ifndef LIGHTSHIFT_TUNING_MAX_TERM
+    #define LIGHTSHIFT_TUNING_MAX_TERM 250
+#endif
+
+// custom extended terms are usually longer, so have their own upper bound
+#ifndef LIGHTSHIFT_TUNING_MAX_EXTENDED_TERM
+    #define LIGHTSHIFT_TUNING_MAX_EXTENDED_TERM 500
+#endif
+
+// time from original letter to its retyping, for a correction to count
+#ifndef LIGHTSHIFT_TUNING_WINDOW
+    #define LIGHTSHIFT_TUNING_WINDOW 2000
+#endif
+
+// quiet time after the last change before tuned terms are saved
+#ifndef LIGHTSHIFT_TUNING_SAVE_DELAY
+    #define LIGHTSHIFT_TUNING_SAVE_DELAY 30000
+#endif
+
+// location of the tuned terms in the user EEPROM datablock
+#ifndef LIGHTSHIFT_TUNING_EEPROM_OFFSET
+    #define LIGHTSHIFT_TUNING_EEPROM_OFFSET 0
+#endif
+
+#if LIGHTSHIFT_TUNING_MIN_TERM > LIGHTSHIFT_TUNING_MAX_TERM
+    #error "LIGHTSHIFT_TUNING_MIN_TERM must not exceed ..._MAX_TERM"
+#endif
+
+/**
+ * @brief Convenience method for access to LIGHTSHIFT_TUNING parameter
+ */
+inline bool lghts_tuning(void) {
+    #ifdef LIGHTSHIFT_TUNING
+        return true;
+    #else
+        return false;
+    #endif
+}
+
+
+/**
+ * @brief Tapping terms, as saved to EEPROM
+ */
+typedef struct {
+    uint16_t magic;         ///< LIGHTSHIFT_TERMS_MAGIC once saved
+    uint16_t term;          ///< lightshift (opposite-side) tapping term
+    uint16_t extended_term; ///< extended (same-side) tapping term
+} lightshift_terms_t;
+
+#define LIGHTSHIFT_TERMS_MAGIC 0x4C53 // "LS"
+#define LIGHTSHIFT_TERMS_SIZE 6       // bytes
+
+
+/**
+ * @brief Loads saved tapping terms
+ * 
+ * By default, reads the EEPROM user datablock (if EECONFIG_USER_DATA_SIZE is
+ * large enough).  Override to store the terms elsewhere.
+ * 
+ * @param terms terms to be filled in
+ * 
+ * @return true if terms were loaded
+ */
+bool lightshift_load_terms(lightshift_terms_t *terms);
+
+
+/**
+ * @brief Saves tuned tapping terms
+ * 
+ * By default, writes the EEPROM user datablock (if EECONFIG_USER_DATA_SIZE
+ * is large enough).  Override to store the terms elsewhere.
+ * 
+ * @param terms terms to be saved
+ */
+void lightshift_save_terms(const lightshift_terms_t *terms);
+
+
+/**
+ * @brief Forgets tuned terms, returning to the configured terms
+ */
+void lightshift_tuning_reset(void);
+
+
+/**
+ * @brief Current (tuned) lightshift tapping term
+ * 
+ * @return tuned term, or LIGHTSHIFT_TAPPING_TERM if tuning is off
+ */
+uint16_t lghts_tuned_term(void);
+
+
+/**
+ * @brief Current (tuned) extended tapping term
+ * 
+ * @return tuned term, or LIGHTSHIFT_EXTENDED_TAPPING_TERM if tuning is off
+ *         or the extended term is left at its default (never expires)
+ */
+uint16_t lghts_tuned_extended_term(void);
+
+
+/**
+ * @brief Notes a tapping term decision, for attributing later corrections
+ * 
+ * @param key Key position which decided the term
+ * @param same_hand true if the extended (same-side) term was chosen
+ * @param shift_keycode Keycode of the lightshift whose term was decided
+ */
+void lghts_tuning_note_decision(keypos_t key, bool same_hand,
+                                uint16_t shift_keycode);
+
+
+/**
+ * @brief Watches for corrections; call from process_record on every event
+ */
+void lghts_tuning_process(uint16_t keycode, const keyrecord_t *record);
+
+
+/**
+ * @brief Loads saved terms; call from keyboard_post_init
+ */
+void lghts_tuning_init(void);
+
+
+/**
+ * @brief Saves changed terms when due; call from housekeeping_task
+ */
+void lghts_tuning_task(void);
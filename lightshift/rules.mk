@@ -1,10 +1,39 @@
+# directory of this module (before any other makefile is included)
+LIGHTSHIFT_PATH := $(dir $(lastword $(MAKEFILE_LIST)))
+
 # notify other modules that lightshift is enabled
 OPT_DEFS += -DLIGHTSHIFT_ENABLE
 
 # add source files
 SRC += lightshift_state.c
 SRC += lightshift_tracking.c
+SRC += lightshift_fsm.c
 SRC += lightshift_drop.c
+SRC += lightshift_adaptive.c
+SRC += lightshift_tuning.c
+SRC += lightshift_bigram.c
+SRC += lightshift_profiles.c
+SRC += lightshift_stats.c
+SRC += lightshift_mods.c
+SRC += lightshift_keyclass.c
+SRC += lightshift_streak.c
+SRC += lightshift_termcost.c
+
+# optionally generate a bigram tapping term table from a corpus or CSV file
+ifneq ($(strip $(LIGHTSHIFT_BIGRAMS)),)
+    LIGHTSHIFT_BIGRAMS_DIR := $(INTERMEDIATE_OUTPUT)/lightshift
+    LIGHTSHIFT_BIGRAMS_ERROR := $(shell python3 \
+        $(LIGHTSHIFT_PATH)tools/gen_bigram_terms.py \
+        $(KEYMAP_PATH)/$(strip $(LIGHTSHIFT_BIGRAMS)) \
+        $(LIGHTSHIFT_BIGRAMS_DIR)/lightshift_bigrams.h \
+        --shifts "$(LIGHTSHIFT_SHIFT_LETTERS)" \
+        --left "$(LIGHTSHIFT_LEFT_LETTERS)" 2>&1)
+    ifneq ($(LIGHTSHIFT_BIGRAMS_ERROR),)
+        $(error Lightshift bigrams: $(LIGHTSHIFT_BIGRAMS_ERROR))
+    endif
+    VPATH += $(LIGHTSHIFT_BIGRAMS_DIR)
+    OPT_DEFS += -DLIGHTSHIFT_BIGRAMS
+endif
 
 # dropshift enabled unless user disables
 DROPSHIFT_ENABLE ?= yes
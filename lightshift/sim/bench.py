@@ -0,0 +1,351 @@
+#!/usr/bin/env python3
+"""
+bench.py - Lightshift accuracy benchmark & parameter sweep
+
+Types a text corpus on a simulated keyboard with home-row shifts, replays it
+through the Lightshift simulator for every combination of settings in a
+grid, and ranks the settings by shift errors:
+
+  missed shifts      a capital typed lower case, or as shift letter + letter
+                     (e.g. "si" for "I")
+  accidental shifts  a lower case letter shifted, or a shift letter lost to a
+                     hold (e.g. "Tring" for "string")
+  double shifts      a second letter shifted after a capital (e.g. "IT")
+
+Key events are synthesised from a timing model: the time from each key press
+to the next depends on the bigram (same key, same hand or opposite hands,
+or an explicit per-bigram time from --timing), with random variation.  A few
+letter keys (--long-holds) linger well past the next press, as in a slow
+same-hand roll, which is what the extended tapping term has to catch.
+Capitals are typed with the lightshift key on the opposite hand, except for
+a share (--same-hand-capitals) typed with the shift on the letter's own hand,
+held down a little longer first.
+
+Each grid point builds its own simulator (terms are compile-time options,
+as on the keyboard), and the points are run in parallel across all cores.
+
+Usage:
+    bench.py <corpus.txt> --shifts LETTERS --left LETTERS
+             [--terms MS,...] [--extended-terms MS,...] [--dropshift yes,no]
+             [--timing bigrams.csv] [--long-holds FRACTION]
+             [--same-hand-capitals FRACTION] [--seed N] [--jobs N]
+             [--write-trace trace.csv]
+
+e.g. (Graphite layout, with shifts on S and E):
+    bench.py corpus/example.txt --shifts se --left bldwvzqgxjnrtsc
+
+The timing CSV has one bigram per line, as   bigram,interval_ms   e.g.
+    st,85
+    th,110
+
+Author: dave-thompson
+"""
+
+import argparse
+import bisect
+import concurrent.futures
+import difflib
+import itertools
+import os
+import random
+import re
+import subprocess
+import sys
+import tempfile
+
+SIM_DIR = os.path.dirname(os.path.abspath(__file__))
+
+# QMK keycodes
+KC_A = 0x04
+KC_SPACE = 0x2C
+KC_COMMA = 0x36
+KC_DOT = 0x37
+KC_QUOTE = 0x34
+MOD_LSFT = 0x02
+MOD_RSFT = 0x12
+
+PUNCTUATION = {" ": KC_SPACE, ",": KC_COMMA, ".": KC_DOT, "'": KC_QUOTE}
+SHIFTED_PUNCTUATION = {"<": ",", ">": ".", '"': "'"}
+
+# timing model defaults (ms)
+SAME_KEY_INTERVAL = 170
+SAME_HAND_INTERVAL = 135
+OPPOSITE_HAND_INTERVAL = 105
+HOLD = 95             # letter key hold
+LONG_HOLD = 450       # lingering letter key hold
+SHIFT_LEAD = 90       # shift press before its letter
+SAME_HAND_SHIFT_LEAD = 180  # ...on the letter's own hand
+SHIFT_TAIL = 45       # shift release after its letter's release
+VARIATION = 0.25      # standard deviation, as a fraction of each time
+
+
+###############################################################################
+#
+# Keyboard Model
+#
+###############################################################################
+
+class Keyboard:
+    """Positions, hands & keycodes for letters, space and punctuation."""
+
+    def __init__(self, shifts, left):
+        self.keys = {}   # char -> (row, col, hand, keycode)
+        self.shift_for = {}   # hand -> char of that hand's lightshift key
+        left_letters = [c for c in "abcdefghijklmnopqrstuvwxyz" if c in left]
+        right_letters = [c for c in "abcdefghijklmnopqrstuvwxyz"
+                         if c not in left]
+        for hand, letters, first_col in (("L", left_letters, 0),
+                                         ("R", right_letters, 6)):
+            for i, letter in enumerate(letters):
+                keycode = KC_A + ord(letter) - ord("a")
+                if letter in shifts:
+                    mods = MOD_LSFT if hand == "L" else MOD_RSFT
+                    keycode = 0x2000 | (mods << 8) | keycode
+                    self.shift_for[hand] = letter
+                self.keys[letter] = (i // 6, first_col + i % 6, hand, keycode)
+        for i, (char, keycode) in enumerate(PUNCTUATION.items()):
+            hand = "*" if char == " " else "R"
+            self.keys[char] = (5, i, hand, keycode)
+        for hand in "LR":
+            if hand not in self.shift_for:
+                sys.exit("--shifts needs a letter on each hand")
+
+    def hand(self, char):
+        return self.keys[char.lower()][2]
+
+
+def clean_corpus(text):
+    """Letters, spaces & simple punctuation only; one space between words."""
+    text = re.sub(r"[^A-Za-z.,' ]+", " ", text)
+    return re.sub(r" +", " ", text).strip()
+
+
+###############################################################################
+#
+# Synthesising Key Events
+#
+###############################################################################
+
+def read_timing(path):
+    timing = {}
+    if path:
+        with open(path, encoding="utf-8") as f:
+            for line in f:
+                bigram, _, interval = line.strip().partition(",")
+                if len(bigram) == 2 and interval.strip().isdigit():
+                    timing[bigram.lower()] = int(interval)
+    return timing
+
+
+def interval(keyboard, timing, prev, char):
+    bigram = (prev + char).lower()
+    if bigram in timing:
+        return timing[bigram]
+    if prev.lower() == char.lower():
+        return SAME_KEY_INTERVAL
+    same = keyboard.hand(prev) == keyboard.hand(char) != "*"
+    return SAME_HAND_INTERVAL if same else OPPOSITE_HAND_INTERVAL
+
+
+def synthesise(text, keyboard, timing, seed, long_holds, same_hand_capitals):
+    """Key events (time, char, pressed) for typing text."""
+    rng = random.Random(seed)
+
+    def vary(ms):
+        return max(10, int(rng.gauss(ms, ms * VARIATION)))
+
+    presses = []    # (time, key char, hold)
+    time = 1000
+    for i, char in enumerate(text):
+        if i:
+            time += vary(interval(keyboard, timing, text[i - 1], char))
+        hold = LONG_HOLD if rng.random() < long_holds else HOLD
+        presses.append([time, char.lower(), vary(hold)])
+
+    events = []
+    next_press = {}   # key char -> time of its next press (to avoid overlap)
+    for press in reversed(presses):
+        time, key, hold = press
+        if key in next_press:
+            press[2] = hold = max(min(hold, next_press[key] - time - 5), 5)
+        events.append((time, key, True))
+        events.append((time + hold, key, False))
+        next_press[key] = time
+
+    # press times of each key, to keep shift holds clear of letter presses
+    key_presses = {}
+    for time, key, _ in presses:
+        key_presses.setdefault(key, []).append(time)
+
+    # capitals: hold a lightshift around the letter (usually the opposite
+    # hand's, else the letter's own hand's, pressed earlier)
+    shift_down = {}   # shift key char -> index of its current hold's release
+    for i, char in enumerate(text):
+        if not char.isupper():
+            continue
+        time, key, hold = presses[i]
+        hand = keyboard.hand(char)
+        lead = SHIFT_LEAD
+        shift = keyboard.shift_for["R" if hand == "L" else "L"]
+        if (rng.random() < same_hand_capitals
+                and keyboard.shift_for[hand] != key):
+            lead = SAME_HAND_SHIFT_LEAD
+            shift = keyboard.shift_for[hand]
+        previous = presses[i - 1][0] if i else 0
+        press = max(time - vary(lead), previous + 5)
+        release = time + hold + rng.gauss(SHIFT_TAIL, SHIFT_TAIL)
+        release = int(max(release, time + 5))
+        # don't collide with the shift key's own presses as a letter
+        times = key_presses.get(shift, [])
+        j = bisect.bisect_right(times, time)
+        if j < len(times):
+            release = min(release, times[j] - 5)
+        if j:
+            press = max(press, times[j - 1] + 20)
+        held = shift_down.get(shift)
+        if held is not None and events[held][0] >= press:
+            # still held from the previous capital: extend that hold
+            events[held] = (max(release, events[held][0]), shift, False)
+            continue
+        events.append((press, shift, True))
+        events.append((release, shift, False))
+        shift_down[shift] = len(events) - 1
+
+    # releases before presses at the same time
+    return sorted(events, key=lambda e: (e[0], e[2]))
+
+
+def write_trace(events, keyboard, path):
+    """Write events in Lumberjack's CSV format."""
+    with open(path, "w", encoding="utf-8") as f:
+        f.write("seq,time,row,col,hand,half,keycode,name,delta,duration,"
+                "pressed\n")
+        for seq, (time, key, pressed) in enumerate(events):
+            row, col, hand, keycode = keyboard.keys[key]
+            f.write("%u,%u,%u,%u,%s,-,%u,\"\",,,%u\n"
+                    % (seq, time % 65536, row, col, hand, keycode, pressed))
+
+
+###############################################################################
+#
+# Scoring
+#
+###############################################################################
+
+def score(expected, typed):
+    """Counts of (words, missed, accidental, double, other) errors."""
+    counts = {"missed": 0, "accidental": 0, "double": 0, "other": 0}
+    expected_words = expected.split(" ")
+    typed_words = typed.split(" ")
+    # align words, so a lost or extra word (e.g. a space dropped by a QMK
+    # waiting buffer overflow) counts once, rather than for every word after
+    pairs = []
+    matcher = difflib.SequenceMatcher(None, expected_words, typed_words,
+                                      autojunk=False)
+    for tag, i1, i2, j1, j2 in matcher.get_opcodes():
+        if tag != "equal":
+            counts["other"] += abs((i2 - i1) - (j2 - j1))
+            pairs += zip(expected_words[i1:i2], typed_words[j1:j2])
+    for want, got in pairs:
+        if len(got) > len(want):      # shift tapped: its letter typed
+            counts["missed"] += 1
+        elif len(got) < len(want):    # letter held: became a shift
+            counts["accidental"] += 1
+        else:
+            for i, (w, g) in enumerate(zip(want, got)):
+                shifted = g.isupper() or SHIFTED_PUNCTUATION.get(g) == w
+                if w.isupper() and not g.isupper():
+                    counts["missed"] += 1
+                elif shifted and not w.isupper():
+                    if i and want[i - 1].isupper() and got[i - 1].isupper():
+                        counts["double"] += 1
+                    else:
+                        counts["accidental"] += 1
+                elif w.lower() != g.lower():
+                    counts["other"] += 1
+    counts["words"] = len(expected_words)
+    return counts
+
+
+###############################################################################
+#
+# Sweep
+#
+###############################################################################
+
+def run_point(point, trace, expected, build_dir):
+    term, extended, dropshift = point
+    binary = os.path.join(build_dir, "sim_%u_%u_%s" % point)
+    defs = "-DLIGHTSHIFT_TAPPING_TERM=%u -DLIGHTSHIFT_EXTENDED_TAPPING_TERM=%u" \
+           % (term, extended)
+    # (the binary is the target: only it is built, away from SIM_DIR)
+    subprocess.run(["make", "-s", "-C", SIM_DIR, "BINARY=" + binary,
+                    "DEFS=" + defs, "DROPSHIFT_ENABLE=" + dropshift, binary],
+                   check=True)
+    typed = subprocess.run([binary, trace], check=True, capture_output=True,
+                           text=True).stdout
+    return point, score(expected, typed)
+
+
+def parse_list(text, kind=int):
+    return [kind(item) for item in text.split(",") if item]
+
+
+def main(argv):
+    parser = argparse.ArgumentParser(
+        description=__doc__.split("\n")[1],
+        formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("corpus")
+    parser.add_argument("--shifts", required=True,
+                        help="tap letters of the lightshift keys")
+    parser.add_argument("--left", required=True,
+                        help="letters typed with the left hand")
+    parser.add_argument("--terms", default="120,140,150,160,180,200")
+    parser.add_argument("--extended-terms", default="300,500,65535")
+    parser.add_argument("--dropshift", default="yes,no")
+    parser.add_argument("--timing", help="per-bigram timing CSV")
+    parser.add_argument("--long-holds", type=float, default=0.05,
+                        help="share of letter keys held long")
+    parser.add_argument("--same-hand-capitals", type=float, default=0.25,
+                        help="share of capitals shifted on their own hand")
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("--jobs", type=int, default=os.cpu_count())
+    parser.add_argument("--write-trace", help="also save the trace here")
+    args = parser.parse_args(argv[1:])
+
+    with open(args.corpus, encoding="utf-8", errors="replace") as f:
+        text = clean_corpus(f.read())
+    keyboard = Keyboard(args.shifts.lower(), args.left.lower())
+    events = synthesise(text, keyboard, read_timing(args.timing), args.seed,
+                        args.long_holds, args.same_hand_capitals)
+
+    grid = list(itertools.product(parse_list(args.terms),
+                                  parse_list(args.extended_terms),
+                                  parse_list(args.dropshift, str)))
+
+    with tempfile.TemporaryDirectory() as build_dir:
+        trace = args.write_trace or os.path.join(build_dir, "trace.csv")
+        write_trace(events, keyboard, trace)
+        with concurrent.futures.ThreadPoolExecutor(args.jobs) as pool:
+            results = list(pool.map(
+                lambda point: run_point(point, trace, text, build_dir), grid))
+
+    words = len(text.split(" "))
+    print("%u words, %u key events, %u settings\n"
+          % (words, len(events), len(grid)))
+    print("Rank  Term  Extended  Dropshift  Missed  Accidental  Double  "
+          "Other  Errors/1000 words")
+    ranked = sorted(results, key=lambda r: (
+        sum(v for k, v in r[1].items() if k != "words"), r[0]))
+    for rank, ((term, extended, dropshift), counts) in enumerate(ranked, 1):
+        errors = (counts["missed"] + counts["accidental"] + counts["double"]
+                  + counts["other"])
+        print("%4u  %4u  %8u  %9s  %6u  %10u  %6u  %5u  %17.2f"
+              % (rank, term, extended, dropshift, counts["missed"],
+                 counts["accidental"], counts["double"], counts["other"],
+                 1000.0 * errors / max(words, 1)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,216 @@
+/**
+ * quantum.h (simulator)
+ * 
+ * Stands in for QMK's quantum.h, so that Lightshift compiles unchanged on
+ * the host.  Only what Lightshift uses is here; keycode values and struct
+ * layouts follow QMK, so traces logged on a real keyboard (e.g. Lumberjack
+ * CSV captures) replay with the same keycodes.
+ */
+
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Keyboard
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// big enough for any keyboard in a trace (positions beyond are ignored)
+#ifndef MATRIX_ROWS
+    #define MATRIX_ROWS 16
+#endif
+#ifndef MATRIX_COLS
+    #define MATRIX_COLS 16
+#endif
+
+#ifndef TAPPING_TERM
+    #define TAPPING_TERM 200
+#endif
+
+#if MATRIX_COLS <= 8
+    typedef uint8_t matrix_row_t;
+#elif MATRIX_COLS <= 16
+    typedef uint16_t matrix_row_t;
+#else
+    typedef uint32_t matrix_row_t;
+#endif
+
+#define PROGMEM
+#define pgm_read_byte(p) (*(const uint8_t*)(p))
+#define pgm_read_word(p) (*(const uint16_t*)(p))
+
+#define ASSERT_COMMUNITY_MODULES_MIN_API_VERSION(major, minor, patch)
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Key Events
+//
+///////////////////////////////////////////////////////////////////////////////
+
+typedef struct {
+    uint8_t col;
+    uint8_t row;
+} keypos_t;
+
+enum { TICK_EVENT = 0, KEY_EVENT = 1 };
+
+typedef struct {
+    keypos_t key;
+    bool     pressed;
+    uint16_t time;
+    uint8_t  type;
+} keyevent_t;
+
+typedef struct {
+    bool    interrupted : 1;
+    bool    reserved2 : 1;
+    bool    reserved1 : 1;
+    bool    reserved0 : 1;
+    uint8_t count : 4;
+} tap_t;
+
+// (QMK has keyrecord_t.keycode with COMBO_ENABLE or REPEAT_KEY_ENABLE, but
+//  its tap-hold engine only reads it with COMBO_ENABLE, as sim_tapping.c
+//  always does)
+#ifndef COMBO_ENABLE
+    #define COMBO_ENABLE
+#endif
+
+typedef struct {
+    keyevent_t event;
+    tap_t      tap;
+    uint16_t   keycode;
+} keyrecord_t;
+
+#define KEYEQ(a, b) ((a).row == (b).row && (a).col == (b).col)
+
+#define TIMER_DIFF_16(a, b) ((uint16_t)((a) - (b)))
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Keycodes (QMK values)
+//
+///////////////////////////////////////////////////////////////////////////////
+
+enum {
+    KC_NO = 0x0000,
+    KC_A = 0x0004,
+    KC_D = 0x0007,
+    KC_E = 0x0008,
+    KC_I = 0x000C,
+    KC_O = 0x0012,
+    KC_R = 0x0015,
+    KC_S = 0x0016,
+    KC_T = 0x0017,
+    KC_Z = 0x001D,
+    KC_1 = 0x001E,
+    KC_0 = 0x0027,
+    KC_ENTER = 0x0028,
+    KC_ESCAPE = 0x0029,
+    KC_BACKSPACE = 0x002A,
+    KC_TAB = 0x002B,
+    KC_SPACE = 0x002C,
+    KC_SLASH = 0x0038,
+    KC_CAPS_LOCK = 0x0039,
+    KC_LEFT_CTRL = 0x00E0,
+    KC_LEFT_SHIFT = 0x00E1,
+    KC_RIGHT_SHIFT = 0x00E5,
+    KC_RIGHT_GUI = 0x00E7,
+    QK_MOD_TAP = 0x2000,
+    QK_MOD_TAP_MAX = 0x3FFF,
+    QK_LAYER_TAP = 0x4000,
+    QK_LAYER_TAP_MAX = 0x4FFF,
+    QK_LAYER_MOD = 0x5000,
+    QK_PERSISTENT_DEF_LAYER_MAX = 0x52FF,
+    QK_LAYER_LOCK = 0x7C7B,
+    QK_KB = 0x7E00,
+};
+
+#define KC_BSPC KC_BACKSPACE
+#define KC_SPC  KC_SPACE
+#define KC_ENT  KC_ENTER
+
+// module keycodes
+#define LIGHTSHIFT_PRINT_STATS QK_KB
+#define LS_STAT LIGHTSHIFT_PRINT_STATS
+
+#define IS_QK_MOD_TAP(k)   ((k) >= QK_MOD_TAP && (k) <= QK_MOD_TAP_MAX)
+#define IS_QK_LAYER_TAP(k) ((k) >= QK_LAYER_TAP && (k) <= QK_LAYER_TAP_MAX)
+#define IS_MODIFIER_KEYCODE(k) ((k) >= KC_LEFT_CTRL && (k) <= KC_RIGHT_GUI)
+
+#define QK_MOD_TAP_GET_MODS(k)          (((k) >> 8) & 0x1F)
+#define QK_MOD_TAP_GET_TAP_KEYCODE(k)   ((k) & 0xFF)
+#define QK_LAYER_TAP_GET_LAYER(k)       (((k) >> 8) & 0x0F)
+#define QK_LAYER_TAP_GET_TAP_KEYCODE(k) ((k) & 0xFF)
+
+#define MT(mods, kc) (QK_MOD_TAP | (((mods) & 0x1F) << 8) | ((kc) & 0xFF))
+
+#define MOD_LCTL 0x01
+#define MOD_LSFT 0x02
+#define MOD_LALT 0x04
+#define MOD_LGUI 0x08
+#define MOD_RCTL 0x11
+#define MOD_RSFT 0x12
+
+#define MOD_BIT(kc) (1 << ((kc) & 0x07))
+#define MOD_MASK_SHIFT (MOD_BIT(KC_LEFT_SHIFT) | MOD_BIT(KC_RIGHT_SHIFT))
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Simulated QMK Services (sim_qmk.c)
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// timers follow the time of the event being replayed
+uint16_t timer_read(void);
+uint32_t timer_read32(void);
+uint16_t timer_elapsed(uint16_t last);
+uint32_t timer_elapsed32(uint32_t last);
+
+// modifiers
+uint8_t get_mods(void);
+void register_mods(uint8_t mods);
+void unregister_mods(uint8_t mods);
+void del_mods(uint8_t mods);
+uint8_t get_weak_mods(void);
+uint8_t get_oneshot_mods(void);
+void clear_keyboard(void);
+
+typedef union {
+    uint8_t raw;
+    struct {
+        bool num_lock : 1;
+        bool caps_lock : 1;
+    };
+} led_t;
+led_t host_keyboard_led_state(void);
+
+// keymap: the keycode last pressed at each position, from the trace
+uint16_t get_event_keycode(keyevent_t event, bool update_layer_cache);
+
+// layers aren't modelled: layer 0 is the default, and stays on
+typedef uint32_t layer_state_t;
+extern layer_state_t layer_state;
+extern layer_state_t default_layer_state;
+
+// handedness, from the trace
+char chordal_hold_handedness(keypos_t key);
+
+// storage & comms
+void eeconfig_read_user_datablock(void *data, uint32_t offset,
+                                  uint32_t length);
+void eeconfig_update_user_datablock(const void *data, uint32_t offset,
+                                    uint32_t length);
+void raw_hid_send(uint8_t *data, uint8_t length);
+
+// debugging
+int xprintf(const char *fmt, ...);
+const char *get_keycode_string(uint16_t keycode);
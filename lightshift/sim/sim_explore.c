@@ -0,0 +1,520 @@
+/**
+ * sim_explore.c
+ *
+ * Lightshift explorer: runs every interleaving of key events, up to a given
+ * depth, through Lightshift and the model of QMK's tap-hold engine.  It
+ * checks Lightshift's invariants after every event, and finds the most loop
+ * iterations any one hook call takes.
+ *
+ * Keys are lightshifts on alternate hands, plus letters on each hand (and
+ * Ctrl mod-taps, to check builds with LIGHTSHIFT_CTRL).  Each
+ * event presses or releases one key, either 1ms after the last event, or
+ * just before or at the next tap-hold deadline (the tapping term or extended
+ * tapping term of the undecided lightshift, or the quick tap term after a
+ * tap).  Every sequence then releases the keys still held and taps Space,
+ * after which no shift may be left tracked and no mod left on.
+ *
+ * Sequences start just before the 16-bit timer wraps, so terms expire
+ * across the wrap.
+ *
+ * Usage:
+ *     lightshift_explore [-n depth] [-s shifts] [-c ctrls] [-l letters]
+ *                        [-k] [-b bound] [-v] [-w trace.csv]
+ *
+ *     -n  key events per sequence, before the closing releases (default 5)
+ *     -s  lightshifts (default 2; 3 or more also overflows the 2 tracked)
+ *     -c  Ctrl mod-taps, on alternate hands (default 0)
+ *     -l  letters per hand (default 1)
+ *     -k  make the last lightshift a combo, outside the matrix
+ *     -b  fail if any hook call takes more than this many loop iterations
+ *     -v  print the sequence taking the most iterations, for each hook
+ *     -w  write a failing sequence as a trace, to replay with lightshift_sim
+ */
+
+#include "quantum.h"
+#include "lightshift.h"
+#include "lightshift_state.h"
+#include "sim_qmk.h"
+#include "sim_hooks.h"
+#include "sim_tapping.h"
+#include <stdarg.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define MAX_DEPTH 12
+#define MAX_SHIFTS 4
+#define MAX_CTRLS 2
+#define MAX_LETTERS 2
+#define MAX_KEYS (MAX_SHIFTS + MAX_CTRLS + 2 * MAX_LETTERS + 1)  // + Space
+#define MAX_STEPS (MAX_DEPTH + MAX_KEYS + 1)         // + closing releases
+#define MAX_OPTIONS (MAX_KEYS * 3)                   // 3 timings per key
+
+// the first sequence event is 100ms before the 16-bit timer wraps
+#define START_TIME (UINT16_MAX + 1 - 100)
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Keys
+//
+///////////////////////////////////////////////////////////////////////////////
+
+typedef struct {
+    keypos_t key;
+    uint16_t keycode;
+    char hand;
+    const char *name;
+} explore_key_t;
+
+// lightshifts, alternating hands
+static const explore_key_t shift_keys[MAX_SHIFTS] = {
+    {{.col = 3, .row = 1}, MT(MOD_LSFT, KC_S), 'L', "LSFT_T(S)"},
+    {{.col = 8, .row = 1}, MT(MOD_RSFT, KC_E), 'R', "RSFT_T(E)"},
+    {{.col = 2, .row = 1}, MT(MOD_LSFT, KC_R), 'L', "LSFT_T(R)"},
+    {{.col = 9, .row = 1}, MT(MOD_RSFT, KC_A), 'R', "RSFT_T(A)"},
+};
+
+// a lightshift outside the matrix, as QMK gives combos (replaces the last
+// lightshift with -k)
+static const explore_key_t combo_shift_key =
+    {{.col = 254, .row = 254}, MT(MOD_RSFT, KC_I), 'R', "combo RSFT_T(I)"};
+
+// Ctrl mod-taps, alternating hands
+static const explore_key_t ctrl_keys[MAX_CTRLS] = {
+    {{.col = 1, .row = 1}, MT(MOD_LCTL, KC_D), 'L', "LCTL_T(D)"},
+    {{.col = 10, .row = 1}, MT(MOD_RCTL, KC_O), 'R', "RCTL_T(O)"},
+};
+
+// letters, left then right
+static const explore_key_t letter_keys[2][MAX_LETTERS] = {
+    {{{.col = 4, .row = 1}, KC_T, 'L', "T"},
+     {{.col = 4, .row = 0}, KC_D, 'L', "D"}},
+    {{{.col = 7, .row = 1}, KC_I, 'R', "I"},
+     {{.col = 7, .row = 0}, KC_O, 'R', "O"}},
+};
+
+static const explore_key_t space_key =
+    {{.col = 5, .row = 3}, KC_SPACE, '*', "Space"};
+
+static explore_key_t keys[MAX_KEYS];
+static uint8_t key_count = 0;    // keys to explore (Space follows them)
+static uint8_t space = 0;        // index of Space
+
+
+static int key_index(keypos_t key) {
+    for (uint8_t i = 0; i <= space; i++) {
+        if (KEYEQ(keys[i].key, key)) return i;
+    }
+    return -1;
+}
+
+
+// 5-bit mod-tap mods to an 8-bit mod mask
+static uint8_t mod_mask(uint16_t keycode) {
+    if (!IS_QK_MOD_TAP(keycode)) return 0;
+    uint8_t mods = QK_MOD_TAP_GET_MODS(keycode);
+    return (mods & 0x10) ? (mods & 0x0F) << 4 : mods;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Sequences
+//
+///////////////////////////////////////////////////////////////////////////////
+
+typedef struct {
+    uint8_t key;
+    bool pressed;
+    uint32_t time;
+} step_t;
+
+static step_t steps[MAX_STEPS];
+static uint8_t steps_run = 0;    // of the current sequence, so far
+
+// physical & decided state of each key in the current sequence
+static bool down[MAX_KEYS];             // physically pressed
+static bool held[MAX_KEYS];             // hold processed; release not yet
+static bool tracked_at_hold[MAX_KEYS];  // tracked when its hold was processed
+
+// for each hook, the sequence taking the most loop iterations
+static step_t worst[SIM_HOOK_COUNT][MAX_STEPS];
+static uint8_t worst_length[SIM_HOOK_COUNT];
+
+static uint8_t depth = 5;
+static uint32_t bound = 0;
+static const char *trace_path = NULL;
+static uint64_t sequences = 0;
+static uint64_t overflowed = 0;    // sequences overflowing QMK's buffer
+static bool combo = false;         // the last lightshift is a combo
+static bool combo_tracked = false; // ...and it has been tracked
+
+
+static void print_steps(FILE *file, const step_t *sequence, uint8_t length) {
+    uint32_t last = START_TIME;
+    for (uint8_t i = 0; i < length; i++) {
+        const step_t *step = &sequence[i];
+        fprintf(file, "  %+7ldms  %-10s %s\n", (long)(step->time - last),
+                keys[step->key].name, step->pressed ? "down" : "up");
+        last = step->time;
+    }
+}
+
+
+// Writes a sequence in Lumberjack's CSV format, as read by lightshift_sim
+static void write_trace(const char *path, const step_t *sequence,
+                        uint8_t length) {
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        perror(path);
+        return;
+    }
+    fputs("seq,time,row,col,hand,half,keycode,name,delta,duration,pressed\n",
+          file);
+    for (uint8_t i = 0; i < length; i++) {
+        const explore_key_t *key = &keys[sequence[i].key];
+        fprintf(file, "%u,%u,%u,%u,%c,-,%u,\"%s\",,,%u\n", i,
+                (uint16_t)sequence[i].time, key->key.row, key->key.col,
+                key->hand, key->keycode, key->name, sequence[i].pressed);
+    }
+    fclose(file);
+}
+
+
+// Reports a broken invariant, with the sequence which broke it, and exits
+static void fail(const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    fprintf(stderr, "INVARIANT BROKEN: ");
+    vfprintf(stderr, fmt, args);
+    fprintf(stderr, "\nafter sequence %llu:\n",
+            (unsigned long long)sequences + 1);
+    va_end(args);
+    print_steps(stderr, steps, steps_run);
+    if (trace_path) write_trace(trace_path, steps, steps_run);
+    exit(1);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Invariants
+//
+///////////////////////////////////////////////////////////////////////////////
+
+static const char *const state_names[LIGHTSHIFT_STATE_COUNT] = {
+    "INACTIVE", "UNRESOLVED", "LIGHTSHIFT TT", "EXTENDED TT",
+    "RELEASED, EXTENDED", "SINGLE SHIFTING", "DOUBLE SHIFTING",
+    "STREAK TAP",
+};
+
+
+// Is this key held, but its shift dropped by Dropshift?
+static bool dropped(uint8_t k) {
+    return held[k] && tracked_at_hold[k] && !is_tracked_lghts(keys[k].key);
+}
+
+
+// Checked after every event
+static void check(void) {
+    // tracked slots agree with the state index and the position index,
+    // and with the key's progress
+    uint8_t active = 0;
+    for (uint8_t slot = 0; slot < 8; slot++) {
+        shift_t shift = get_lghts(slot);
+        if (shift.state == SHIFT_INACTIVE) continue;
+        active++;
+        if (shift.state >= LIGHTSHIFT_STATE_COUNT) {
+            fail("slot %u in invalid state %d", slot, shift.state);
+        }
+        const char *state = state_names[shift.state];
+        if (!(lghts_slots_in_state(shift.state) & (1 << slot))) {
+            fail("slot %u (%s) missing from the state index", slot, state);
+        }
+        if (!is_tracked_lghts(shift.key)) {
+            fail("slot %u (%s) missing from the position index", slot, state);
+        }
+        int k = key_index(shift.key);
+        if (k < 0 || !is_lightshift_mod(keys[k].keycode)) {
+            fail("slot %u (%s) tracks a key which isn't a lightshift", slot,
+                 state);
+        }
+        if (combo && KEYEQ(shift.key, combo_shift_key.key)) {
+            combo_tracked = true;
+        }
+        if (lghts_get_keycode(shift.key) != keys[k].keycode) {
+            fail("slot %u (%s) looks up keycode 0x%04X, not %s's", slot,
+                 state, lghts_get_keycode(shift.key), keys[k].name);
+        }
+        bool ok = true;
+        switch (shift.state) {
+            case SHIFT_UNRESOLVED:
+            case SHIFT_LIGHTSHIFT_TT:
+            case SHIFT_EXTENDED_TT:
+                // (without Dropshift, holds don't move shifts on)
+                ok = down[k] && (!held[k] || !lghts_dropshift());
+                break;
+            case SHIFT_RELEASED_EXTENDED:
+                ok = !down[k] && !held[k];
+                break;
+            case SHIFT_STREAK_TAP:
+                ok = down[k] && !held[k];
+                break;
+            default: // SINGLE / DOUBLE SHIFTING
+                ok = held[k];
+                break;
+        }
+        if (!ok) {
+            fail("%s %s, but %s, %s", keys[k].name, state,
+                 down[k] ? "down" : "up", held[k] ? "held" : "not held");
+        }
+    }
+    if (active != num_active_lghts()) {
+        fail("%u slots in use, but %u active lightshifts", active,
+             num_active_lghts());
+    }
+    uint8_t indexed = 0;
+    for (uint8_t state = 1; state < LIGHTSHIFT_STATE_COUNT; state++) {
+        indexed += __builtin_popcount(
+                       lghts_slots_in_state((lightshift_state_t)state));
+    }
+    if (indexed != active) {
+        fail("%u slots in use, but %u in the state index", active, indexed);
+    }
+    uint8_t positions = 0;
+    for (uint8_t k = 0; k <= space; k++) {
+        if (is_tracked_lghts(keys[k].key)) positions++;
+    }
+    if (positions != active) {
+        fail("%u slots in use, but %u in the position index", active,
+             positions);
+    }
+
+    // every mod is held by a key whose hold has been processed (and not
+    // dropped by lghts_clear_modtap_mods())
+    uint8_t owned = 0;
+    for (uint8_t k = 0; k < key_count; k++) {
+        if (held[k] && !dropped(k)) owned |= mod_mask(keys[k].keycode);
+    }
+    if (get_mods() & ~owned) {
+        fail("mods 0x%02X stuck on", get_mods() & ~owned);
+    }
+}
+
+
+// Checked once every key is released, and Space tapped
+static void check_quiescent(void) {
+    if (sim_tapping_pending()) fail("tap-hold decision still pending");
+    for (uint8_t slot = 0; slot < 8; slot++) {
+        shift_t shift = get_lghts(slot);
+        if (shift.state != SHIFT_INACTIVE) {
+            int k = key_index(shift.key);
+            fail("%s leaked in slot %u (%s)", k < 0 ? "?" : keys[k].name, slot,
+                 state_names[shift.state]);
+        }
+    }
+    if (num_active_lghts()) {
+        fail("%u lightshifts still active", num_active_lghts());
+    }
+    if (get_mods()) fail("mods 0x%02X stuck on", get_mods());
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Running Sequences
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Called by the tap-hold engine for each decided key event
+void sim_process_record(keyrecord_t *record) {
+    int k = key_index(record->event.key);
+    bool hold = IS_QK_MOD_TAP(record->keycode) && !record->tap.count;
+
+    if (sim_hook_process_record(record)) sim_key_action(record);
+
+    if (k >= 0 && hold) {
+        held[k] = record->event.pressed;
+        if (record->event.pressed) {
+            tracked_at_hold[k] = is_tracked_lghts(keys[k].key);
+        }
+    }
+}
+
+
+static void run_step(const step_t *step) {
+    sim_set_time(step->time);
+
+    // holds whose terms expired before this event
+    sim_tapping_tick();
+    check();
+
+    keyrecord_t record = {0};
+    record.event.key = keys[step->key].key;
+    record.event.pressed = step->pressed;
+    record.event.time = (uint16_t)step->time;
+    record.event.type = KEY_EVENT;
+    record.keycode = keys[step->key].keycode;
+    down[step->key] = step->pressed;
+    steps_run++;
+
+    if (sim_hook_pre_process_record(&record)) sim_tapping_event(&record);
+    sim_hook_housekeeping();
+    check();
+}
+
+
+static void add_step(uint8_t key, bool pressed, uint32_t time) {
+    steps[steps_run] = (step_t){key, pressed, time};
+    run_step(&steps[steps_run]);
+}
+
+
+// Runs the first length steps, then lists the possible next steps in
+// options, then closes the sequence.  Returns the number of options.
+static uint8_t run_sequence(uint8_t length, step_t options[MAX_OPTIONS]) {
+    uint32_t overflows = sim_tapping_overflows();
+    uint32_t max_before[SIM_HOOK_COUNT];
+    for (uint8_t h = 0; h < SIM_HOOK_COUNT; h++) {
+        max_before[h] = sim_hook_costs[h].max_iterations;
+    }
+
+    sim_tapping_reset();
+    sim_output_clear();
+    sim_set_time(START_TIME);
+    memset(down, 0, sizeof(down));
+    memset(held, 0, sizeof(held));
+    steps_run = 0;
+    while (steps_run < length) run_step(&steps[steps_run]);
+
+    // next steps: toggle any key, 1ms on or either side of a deadline
+    uint8_t count = 0;
+    if (length < depth) {
+        uint32_t now = sim_time();
+        uint32_t times[3] = {now + 1};
+        uint8_t timings = 1;
+        uint32_t deadline;
+        if (sim_tapping_deadline(&deadline)) {
+            if (deadline - 1 > now + 1) times[timings++] = deadline - 1;
+            if (deadline > now + 1) times[timings++] = deadline;
+        }
+        for (uint8_t k = 0; k < key_count; k++) {
+            for (uint8_t t = 0; t < timings; t++) {
+                options[count++] = (step_t){k, !down[k], times[t]};
+            }
+        }
+    }
+
+    // close: release everything, then tap Space (which ends any
+    // RELEASED, EXTENDED)
+    for (uint8_t k = 0; k < key_count; k++) {
+        if (down[k]) add_step(k, false, sim_time() + 1);
+    }
+    add_step(space, true, sim_time() + 1);
+    add_step(space, false, sim_time() + 1);
+    check_quiescent();
+
+    // remember sequences which set new worst cases
+    for (uint8_t h = 0; h < SIM_HOOK_COUNT; h++) {
+        if (sim_hook_costs[h].max_iterations > max_before[h]) {
+            memcpy(worst[h], steps, sizeof(step_t) * steps_run);
+            worst_length[h] = steps_run;
+            if (bound && sim_hook_costs[h].max_iterations > bound) {
+                fail("%s took %lu loop iterations (bound %lu)",
+                     sim_hook_names[h],
+                     (unsigned long)sim_hook_costs[h].max_iterations,
+                     (unsigned long)bound);
+            }
+        }
+    }
+    if (sim_tapping_overflows() != overflows) overflowed++;
+    sequences++;
+    return count;
+}
+
+
+// Depth-first: every sequence starting with the first length steps
+static void explore(uint8_t length) {
+    step_t options[MAX_OPTIONS];
+    uint8_t count = run_sequence(length, options);
+    for (uint8_t i = 0; i < count; i++) {
+        steps[length] = options[i];
+        explore(length + 1);
+    }
+}
+
+
+static void usage(const char *program) {
+    fprintf(stderr, "Usage: %s [-n depth] [-s shifts] [-l letters] "
+                    "[-k] [-b bound] [-v] [-w trace.csv]\n", program);
+}
+
+
+int main(int argc, char **argv) {
+    uint8_t shifts = 2, ctrls = 0, letters = 1;
+    bool verbose = false;
+    int option;
+    while ((option = getopt(argc, argv, "n:s:c:l:kb:vw:")) != -1) {
+        switch (option) {
+            case 'n': depth = atoi(optarg); break;
+            case 's': shifts = atoi(optarg); break;
+            case 'c': ctrls = atoi(optarg); break;
+            case 'l': letters = atoi(optarg); break;
+            case 'k': combo = true; break;
+            case 'b': bound = strtoul(optarg, NULL, 10); break;
+            case 'v': verbose = true; break;
+            case 'w': trace_path = optarg; break;
+            default: usage(argv[0]); return 2;
+        }
+    }
+    if (optind != argc || depth < 1 || depth > MAX_DEPTH || shifts < 1
+            || shifts > MAX_SHIFTS || ctrls > MAX_CTRLS
+            || letters > MAX_LETTERS) {
+        usage(argv[0]);
+        fprintf(stderr, "(depth 1-%u, shifts 1-%u, ctrls 0-%u, "
+                "letters 0-%u)\n", MAX_DEPTH, MAX_SHIFTS, MAX_CTRLS,
+                MAX_LETTERS);
+        return 2;
+    }
+
+    for (uint8_t i = 0; i < shifts; i++) keys[key_count++] = shift_keys[i];
+    if (combo) keys[shifts - 1] = combo_shift_key;
+    for (uint8_t i = 0; i < ctrls; i++) keys[key_count++] = ctrl_keys[i];
+    for (uint8_t hand = 0; hand < 2; hand++) {
+        for (uint8_t i = 0; i < letters; i++) {
+            keys[key_count++] = letter_keys[hand][i];
+        }
+    }
+    space = key_count;
+    keys[space] = space_key;
+    for (uint8_t k = 0; k <= space; k++) sim_set_hand(keys[k].key, keys[k].hand);
+
+    sim_qmk_init(false, false);
+    sim_tapping_report_overflows(false);
+    sim_hook_post_init();
+    explore(0);
+    if (combo && !combo_tracked) {
+        fprintf(stderr, "INVARIANT BROKEN: %s never tracked\n",
+                combo_shift_key.name);
+        return 1;
+    }
+
+    printf("Explored %llu sequences of up to %u key events "
+           "(%u lightshifts, %u Ctrls, %u letters per hand)\n",
+           (unsigned long long)sequences, depth, shifts, ctrls, letters);
+    if (overflowed) {
+        printf("(%llu overflowed QMK's waiting buffer, clearing the "
+               "keyboard)\n", (unsigned long long)overflowed);
+    }
+    printf("All invariants held\n\n");
+    sim_hook_print_costs(stdout);
+    if (verbose) {
+        for (uint8_t h = 0; h < SIM_HOOK_COUNT; h++) {
+            if (!worst_length[h]) continue;
+            printf("\nMost iterations in %s (%lu):\n", sim_hook_names[h],
+                   (unsigned long)sim_hook_costs[h].max_iterations);
+            print_steps(stdout, worst[h], worst_length[h]);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,90 @@
+#include "sim_hooks.h"
+#include "sim_qmk.h"
+
+// module hooks (declared by QMK's generated community module code)
+void keyboard_post_init_lightshift(void);
+void housekeeping_task_lightshift(void);
+bool pre_process_record_lightshift(uint16_t keycode, keyrecord_t *record);
+bool process_record_lightshift(uint16_t keycode, keyrecord_t *record);
+uint16_t get_tapping_term(uint16_t keycode, keyrecord_t *record);
+
+// counted by lghts_probe_iteration()
+uint32_t lghts_probe_iterations = 0;
+
+sim_hook_cost_t sim_hook_costs[SIM_HOOK_COUNT];
+
+const char *const sim_hook_names[SIM_HOOK_COUNT] = {
+    "pre_process_record",
+    "process_record",
+    "get_tapping_term",
+    "housekeeping_task",
+};
+
+
+static void start(void) {
+    lghts_probe_iterations = 0;
+}
+
+static void finish(sim_hook_t hook) {
+    sim_hook_cost_t *cost = &sim_hook_costs[hook];
+    cost->calls++;
+    cost->iterations += lghts_probe_iterations;
+    if (lghts_probe_iterations > cost->max_iterations) {
+        cost->max_iterations = lghts_probe_iterations;
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Hooks
+//
+///////////////////////////////////////////////////////////////////////////////
+
+void sim_hook_post_init(void) {
+    keyboard_post_init_lightshift();
+}
+
+bool sim_hook_pre_process_record(keyrecord_t *record) {
+    // (as QMK updates its source layer cache before pre_process_record)
+    if (record->event.pressed) {
+        sim_set_keycode(record->event.key, record->keycode);
+    }
+    start();
+    bool result = pre_process_record_lightshift(record->keycode, record);
+    finish(SIM_HOOK_PRE_PROCESS_RECORD);
+    return result;
+}
+
+bool sim_hook_process_record(keyrecord_t *record) {
+    start();
+    bool result = process_record_lightshift(record->keycode, record);
+    finish(SIM_HOOK_PROCESS_RECORD);
+    return result;
+}
+
+uint16_t sim_hook_tapping_term(keyrecord_t *record) {
+    start();
+    uint16_t term = get_tapping_term(record->keycode, record);
+    finish(SIM_HOOK_TAPPING_TERM);
+    return term;
+}
+
+void sim_hook_housekeeping(void) {
+    start();
+    housekeeping_task_lightshift();
+    finish(SIM_HOOK_HOUSEKEEPING);
+}
+
+
+void sim_hook_print_costs(FILE *file) {
+    fprintf(file, "%-20s %12s %12s %10s\n", "Hook", "Calls",
+            "Iterations", "Max/call");
+    for (uint8_t i = 0; i < SIM_HOOK_COUNT; i++) {
+        const sim_hook_cost_t *cost = &sim_hook_costs[i];
+        fprintf(file, "%-20s %12llu %12llu %10lu\n", sim_hook_names[i],
+                (unsigned long long)cost->calls,
+                (unsigned long long)cost->iterations,
+                (unsigned long)cost->max_iterations);
+    }
+}
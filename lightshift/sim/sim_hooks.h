@@ -0,0 +1,39 @@
+/**
+ * sim_hooks.h
+ * 
+ * Calls into Lightshift's QMK hooks, counting the loop iterations each call
+ * takes (Lightshift is built with LIGHTSHIFT_COST_PROBE).
+ */
+
+#pragma once
+#include "quantum.h"
+
+typedef enum {
+    SIM_HOOK_PRE_PROCESS_RECORD,
+    SIM_HOOK_PROCESS_RECORD,
+    SIM_HOOK_TAPPING_TERM,
+    SIM_HOOK_HOUSEKEEPING,
+    SIM_HOOK_COUNT,
+} sim_hook_t;
+
+typedef struct {
+    uint64_t calls;
+    uint64_t iterations;      ///< loop iterations, over all calls
+    uint32_t max_iterations;  ///< most loop iterations in any one call
+} sim_hook_cost_t;
+
+extern sim_hook_cost_t sim_hook_costs[SIM_HOOK_COUNT];
+extern const char *const sim_hook_names[SIM_HOOK_COUNT];
+
+
+void sim_hook_post_init(void);
+bool sim_hook_pre_process_record(keyrecord_t *record);
+bool sim_hook_process_record(keyrecord_t *record);
+uint16_t sim_hook_tapping_term(keyrecord_t *record);
+void sim_hook_housekeeping(void);
+
+
+/**
+ * @brief Prints each hook's calls and loop iterations
+ */
+void sim_hook_print_costs(FILE *file);
@@ -0,0 +1,5 @@
+// QMK compiles a module's introspection.c alongside the keymap, where the
+// module's headers are visible; the simulator does the same
+#include "lightshift.h"
+#include "lightshift_state.h"
+#include "../introspection.c"
@@ -0,0 +1,155 @@
+/**
+ * sim_main.c
+ * 
+ * Lightshift simulator: replays a key event trace through Lightshift and a
+ * model of QMK's tap-hold engine, and prints the text that would be typed.
+ * 
+ * Usage:
+ *     lightshift_sim [-r] [-v] [-d] <trace.csv | ->
+ * 
+ *     -r  raw: type Backspace as '\b' rather than applying it
+ *     -v  verbose: print each decided key event, and a summary with each
+ *         hook's loop iterations (to stderr), and tapping term costs (build
+ *         with DEFS=-DLIGHTSHIFT_TERM_COSTS)
+ *     -d  print Lightshift's debug output (build with DEFS=-DLIGHTSHIFT_DEBUG)
+ */
+
+#include "quantum.h"
+#include "lightshift.h"
+#include "sim_qmk.h"
+#include "sim_hooks.h"
+#include "sim_tapping.h"
+#include "sim_trace.h"
+#include "lightshift_termcost.h"
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+static bool verbose = false;
+
+
+#ifdef LIGHTSHIFT_TERM_COSTS
+// Tapping term costs (the simulator ends a "scan" after each event, and
+// "cycles" are ns on the host)
+static void print_term_costs(FILE *file) {
+    const lightshift_term_costs_t *costs = lightshift_get_term_costs();
+    const lightshift_range_t *ranges[] = {&costs->calls_per_scan,
+                                          &costs->calls_per_press,
+                                          &costs->cycles_per_call};
+    const char *names[] = {"calls/event", "calls/press", "ns/call"};
+    fprintf(file, "%-20s %12s %12s %10s %12s\n", "get_lightshift_term",
+            "Min", "Avg", "Max", "Samples");
+    for (uint8_t i = 0; i < 3; i++) {
+        const lightshift_range_t *range = ranges[i];
+        fprintf(file, "%-20s %12lu %12.1f %10lu %12lu\n", names[i],
+                (unsigned long)range->min,
+                range->samples ? (double)range->total / range->samples : 0,
+                (unsigned long)range->max, (unsigned long)range->samples);
+    }
+}
+#endif
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Key Actions
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Called by the tap-hold engine for each decided key event
+void sim_process_record(keyrecord_t *record) {
+    uint16_t keycode = record->keycode;
+    bool pressed = record->event.pressed;
+
+    if (verbose) {
+        const char *kind = !(IS_QK_MOD_TAP(keycode) || IS_QK_LAYER_TAP(keycode))
+                           ? "" : record->tap.count ? " tap" : " hold";
+        fprintf(stderr, "%7lu %-7s 0x%04X%s\n", (unsigned long)sim_time(),
+                pressed ? "down" : "up", keycode, kind);
+    }
+
+    if (sim_hook_process_record(record)) sim_key_action(record);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Replay
+//
+///////////////////////////////////////////////////////////////////////////////
+
+static void replay(const sim_trace_t *trace) {
+    for (size_t i = 0; i < trace->count; i++) {
+        sim_set_hand(trace->events[i].key, trace->events[i].hand);
+    }
+    sim_hook_post_init();
+
+    for (size_t i = 0; i < trace->count; i++) {
+        const sim_event_t *event = &trace->events[i];
+        sim_set_time(event->time);
+
+        // holds whose terms expired before this event
+        sim_tapping_tick();
+
+        keyrecord_t record = {0};
+        record.event.key = event->key;
+        record.event.pressed = event->pressed;
+        record.event.time = (uint16_t)event->time;
+        record.event.type = 1; // KEY_EVENT
+        record.keycode = event->keycode;
+
+        if (sim_hook_pre_process_record(&record)) {
+            sim_tapping_event(&record);
+        }
+        sim_hook_housekeeping();
+    }
+
+    // let any pending decisions play out
+    if (trace->count) {
+        sim_set_time(trace->events[trace->count - 1].time + UINT16_MAX - 1);
+        sim_tapping_tick();
+    }
+}
+
+
+int main(int argc, char **argv) {
+    bool raw = false, debug = false;
+    int option;
+    while ((option = getopt(argc, argv, "rvd")) != -1) {
+        switch (option) {
+            case 'r': raw = true; break;
+            case 'v': verbose = true; break;
+            case 'd': debug = true; break;
+            default:
+                fprintf(stderr, "Usage: %s [-r] [-v] [-d] <trace.csv | ->\n",
+                        argv[0]);
+                return 2;
+        }
+    }
+    if (optind != argc - 1) {
+        fprintf(stderr, "Usage: %s [-r] [-v] [-d] <trace.csv | ->\n", argv[0]);
+        return 2;
+    }
+
+    sim_trace_t trace;
+    if (!sim_trace_read(argv[optind], &trace)) return 1;
+    sim_qmk_init(raw, debug);
+
+    clock_t start = clock();
+    replay(&trace);
+    double elapsed = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    fputs(sim_output(), stdout);
+    if (verbose && trace.count) {
+        double typed = (trace.events[trace.count - 1].time
+                        - trace.events[0].time) / 1000.0;
+        fprintf(stderr, "Replayed %zu events (%.0fs of typing) in %.3fs\n",
+                trace.count, typed, elapsed);
+        sim_hook_print_costs(stderr);
+        #ifdef LIGHTSHIFT_TERM_COSTS
+            print_term_costs(stderr);
+        #endif
+    }
+    sim_trace_free(&trace);
+    return 0;
+}
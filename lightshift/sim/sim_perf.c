@@ -0,0 +1,179 @@
+/**
+ * sim_perf.c
+ *
+ * Lightshift hook benchmark: times pre_process_record and process_record
+ * per key event, with 0, 1 and 2 lightshifts active, and counts the loop
+ * iterations each event takes.
+ *
+ * Two workloads:
+ *     held   shifts held (shifting) while other keys are typed
+ *     rolls  shifts pressed, then a letter on the other hand, then both
+ *            released: every event resolves, releases or starts a shift
+ *
+ * Hooks are called directly (no tap-hold engine), so the times are
+ * Lightshift's alone.  Compare builds before and after a change; times vary
+ * from machine to machine, iterations don't.
+ *
+ * Usage:
+ *     lightshift_perf [-r repeats]
+ */
+
+#include "quantum.h"
+#include "lightshift.h"
+#include "lightshift_state.h"
+#include "sim_qmk.h"
+#include "sim_hooks.h"
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MAX_ACTIVE 2
+
+static const keypos_t shift_pos[MAX_ACTIVE] = {{.col = 3, .row = 1},
+                                               {.col = 8, .row = 1}};
+static const uint16_t shift_keycode[MAX_ACTIVE] = {MT(MOD_LSFT, KC_S),
+                                                   MT(MOD_RSFT, KC_E)};
+static const keypos_t left_pos = {.col = 4, .row = 1};
+static const keypos_t right_pos = {.col = 7, .row = 1};
+
+static uint32_t now = 1000;
+static uint64_t events = 0;
+
+
+// tap-hold engine stand-in (sim_tapping.c isn't linked)
+void sim_process_record(keyrecord_t *record) {
+    (void)record;
+}
+
+
+// One key event through both hooks (pr sees tap_count, as QMK decided it)
+static void event(keypos_t key, uint16_t keycode, bool pressed,
+                  uint8_t tap_count) {
+    keyrecord_t record = {0};
+    record.event.key = key;
+    record.event.pressed = pressed;
+    record.event.time = (uint16_t)now;
+    record.event.type = KEY_EVENT;
+    record.keycode = keycode;
+    sim_set_time(now++);
+    sim_hook_pre_process_record(&record);
+    record.tap.count = tap_count;
+    sim_hook_process_record(&record);
+    events++;
+}
+
+
+// the first active shifts, held: pressed, then their terms expire
+static void hold_shifts(uint8_t active, bool pressed) {
+    for (uint8_t i = 0; i < active; i++) {
+        event(shift_pos[i], shift_keycode[i], pressed, 0);
+    }
+}
+
+
+// non-letters, which neither consume the single shift nor drop a double
+static void workload_held(uint8_t active, uint32_t repeats) {
+    hold_shifts(active, true);
+    for (uint32_t r = 0; r < repeats; r++) {
+        event(left_pos, KC_1, true, 0);
+        event(left_pos, KC_1, false, 0);
+        event(right_pos, KC_0, true, 0);
+        event(right_pos, KC_0, false, 0);
+    }
+    hold_shifts(active, false);
+}
+
+
+static void workload_rolls(uint8_t active, uint32_t repeats) {
+    for (uint32_t r = 0; r < repeats; r++) {
+        // the left shift rolls into a right-hand letter, and vice versa
+        bool left = r & 1;
+        keypos_t letter = left ? right_pos : left_pos;
+        uint16_t letter_keycode = left ? KC_I : KC_T;
+        for (uint8_t i = 0; i < active; i++) {
+            keyrecord_t record = {0};
+            record.event.key = shift_pos[i];
+            record.event.pressed = true;
+            record.event.type = KEY_EVENT;
+            record.keycode = shift_keycode[i];
+            sim_set_time(now++);
+            sim_hook_pre_process_record(&record);
+            events++;
+        }
+        event(letter, letter_keycode, true, 0);
+        for (uint8_t i = 0; i < active; i++) {
+            // tapped: QMK processes the press and release together
+            keyrecord_t record = {0};
+            record.event.key = shift_pos[i];
+            record.event.type = KEY_EVENT;
+            record.keycode = shift_keycode[i];
+            sim_set_time(now++);
+            sim_hook_pre_process_record(&record);
+            record.tap.count = 1;
+            record.event.pressed = true;
+            sim_hook_process_record(&record);
+            record.event.pressed = false;
+            sim_hook_process_record(&record);
+            events++;
+        }
+        event(letter, letter_keycode, false, 0);
+    }
+}
+
+
+static double seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+static void run(const char *name, void (*workload)(uint8_t, uint32_t),
+                uint8_t active, uint32_t repeats) {
+    memset(sim_hook_costs, 0, sizeof(sim_hook_costs));
+    events = 0;
+    double start = seconds();
+    workload(active, repeats);
+    double elapsed = seconds() - start;
+    uint64_t iterations =
+        sim_hook_costs[SIM_HOOK_PRE_PROCESS_RECORD].iterations
+        + sim_hook_costs[SIM_HOOK_PROCESS_RECORD].iterations;
+    printf("%-8s %6u %14.1f %18.2f\n", name, active,
+           elapsed * 1e9 / events, (double)iterations / events);
+    if (num_active_lghts()) {
+        fprintf(stderr, "%s: %u lightshifts left active\n", name,
+                num_active_lghts());
+        exit(1);
+    }
+}
+
+
+int main(int argc, char **argv) {
+    uint32_t repeats = 2000000;
+    int opt;
+    while ((opt = getopt(argc, argv, "r:")) != -1) {
+        if (opt == 'r') {
+            repeats = atoi(optarg);
+        }
+        else {
+            fprintf(stderr, "usage: %s [-r repeats]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    sim_qmk_init(true, false);
+    sim_set_hand(shift_pos[0], 'L');
+    sim_set_hand(shift_pos[1], 'R');
+    sim_set_hand(left_pos, 'L');
+    sim_set_hand(right_pos, 'R');
+    sim_hook_post_init();
+
+    printf("Workload  Active  ns/event  Loop iterations/event\n");
+    for (uint8_t active = 0; active <= MAX_ACTIVE; active++) {
+        run("held", workload_held, active, repeats);
+    }
+    for (uint8_t active = 0; active <= MAX_ACTIVE; active++) {
+        run("rolls", workload_rolls, active, repeats);
+    }
+    return 0;
+}
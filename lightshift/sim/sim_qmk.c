@@ -0,0 +1,298 @@
+#include "sim_qmk.h"
+#include <stdarg.h>
+#include <stdlib.h>
+#include <time.h>
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// State
+//
+///////////////////////////////////////////////////////////////////////////////
+
+static uint32_t now = 0;
+static uint8_t mods = 0;
+static bool caps_lock = false;
+
+static bool raw_output = false;
+static bool debug_output = false;
+
+// typed text
+static char *output = NULL;
+static size_t output_len = 0, output_size = 0;
+
+// handedness per position, as logged in the trace ('L', 'R', '*' or 0)
+static char hands[MATRIX_ROWS][MATRIX_COLS];
+static uint8_t max_col = 0;
+
+// keycode per position, as last pressed in the trace
+static uint16_t keymap[MATRIX_ROWS][MATRIX_COLS];
+layer_state_t layer_state = 0;
+layer_state_t default_layer_state = 1;
+
+// user EEPROM datablock
+static uint8_t eeprom[1024];
+
+
+void sim_qmk_init(bool raw, bool debug) {
+    raw_output = raw;
+    debug_output = debug;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Timers
+//
+///////////////////////////////////////////////////////////////////////////////
+
+void sim_set_time(uint32_t time) {
+    now = time;
+}
+
+uint32_t sim_time(void) {
+    return now;
+}
+
+uint16_t timer_read(void) {
+    return (uint16_t)now;
+}
+
+uint32_t timer_read32(void) {
+    return now;
+}
+
+uint16_t timer_elapsed(uint16_t last) {
+    return TIMER_DIFF_16((uint16_t)now, last);
+}
+
+uint32_t timer_elapsed32(uint32_t last) {
+    return now - last;
+}
+
+// for LIGHTSHIFT_TERM_COSTS: real (not simulated) time, in ns
+uint32_t lightshift_read_cycles(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Modifiers
+//
+///////////////////////////////////////////////////////////////////////////////
+
+uint8_t get_mods(void) {
+    return mods;
+}
+
+void register_mods(uint8_t new_mods) {
+    mods |= new_mods;
+}
+
+void unregister_mods(uint8_t old_mods) {
+    mods &= ~old_mods;
+}
+
+void del_mods(uint8_t old_mods) {
+    mods &= ~old_mods;
+}
+
+void clear_keyboard(void) {
+    mods = 0;
+}
+
+uint8_t get_weak_mods(void) {
+    return 0;
+}
+
+uint8_t get_oneshot_mods(void) {
+    return 0;
+}
+
+led_t host_keyboard_led_state(void) {
+    led_t state = {0};
+    state.caps_lock = caps_lock;
+    return state;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Keymap
+//
+///////////////////////////////////////////////////////////////////////////////
+
+void sim_set_keycode(keypos_t key, uint16_t keycode) {
+    if (key.row >= MATRIX_ROWS || key.col >= MATRIX_COLS) return;
+    keymap[key.row][key.col] = keycode;
+}
+
+// traces record each key's keycode on its layer, which is what QMK's source
+// layer cache gives for a held key
+uint16_t get_event_keycode(keyevent_t event, bool update_layer_cache) {
+    if (event.key.row >= MATRIX_ROWS || event.key.col >= MATRIX_COLS) {
+        return KC_NO;
+    }
+    return keymap[event.key.row][event.key.col];
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Handedness
+//
+///////////////////////////////////////////////////////////////////////////////
+
+void sim_set_hand(keypos_t key, char hand) {
+    if (key.row >= MATRIX_ROWS || key.col >= MATRIX_COLS) return;
+    if (hand == 'L' || hand == 'R' || hand == '*') hands[key.row][key.col] = hand;
+    if (key.col > max_col) max_col = key.col;
+}
+
+// hands as logged, else a guess from which half of the columns the key is in
+char lightshift_handedness(keypos_t key) {
+    if (key.row < MATRIX_ROWS && key.col < MATRIX_COLS
+            && hands[key.row][key.col]) {
+        return hands[key.row][key.col];
+    }
+    return key.col <= max_col / 2 ? 'L' : 'R';
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Host Output
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// US layout: unshifted & shifted characters from KC_A (0x04) to KC_SLASH
+static const char unshifted[] =
+    "abcdefghijklmnopqrstuvwxyz1234567890\n\0\b\t -=[]\\#;'`,./";
+static const char shifted[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZ!@#$%^&*()\n\0\b\t _+{}|~:\"~<>?";
+
+static void type_char(char c) {
+    if (c == '\b' && !raw_output) {
+        if (output_len) output[--output_len] = '\0';
+        return;
+    }
+    if (output_len + 2 > output_size) {
+        output_size = output_size ? output_size * 2 : 4096;
+        output = realloc(output, output_size);
+        if (!output) {
+            fprintf(stderr, "Out of memory\n");
+            exit(1);
+        }
+    }
+    output[output_len++] = c;
+    output[output_len] = '\0';
+}
+
+void sim_send_key(uint16_t keycode, bool pressed) {
+    if (IS_MODIFIER_KEYCODE(keycode)) {
+        if (pressed) register_mods(MOD_BIT(keycode));
+        else unregister_mods(MOD_BIT(keycode));
+        return;
+    }
+    if (!pressed) return;
+    if (keycode == KC_CAPS_LOCK) {
+        caps_lock = !caps_lock;
+        return;
+    }
+    if (keycode < KC_A || keycode > KC_SLASH) return;
+
+    uint8_t i = keycode - KC_A;
+    bool shift = mods & MOD_MASK_SHIFT;
+    if (keycode <= KC_Z && caps_lock) shift = !shift;
+    char c = shift ? shifted[i] : unshifted[i];
+    if (c) type_char(c);
+}
+
+const char *sim_output(void) {
+    return output ? output : "";
+}
+
+void sim_output_clear(void) {
+    output_len = 0;
+    if (output) output[0] = '\0';
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Key Actions
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// 5-bit mod-tap mods to an 8-bit mod mask
+static uint8_t mod_mask(uint16_t keycode) {
+    uint8_t mods = QK_MOD_TAP_GET_MODS(keycode);
+    return (mods & 0x10) ? (mods & 0x0F) << 4 : mods;
+}
+
+void sim_key_action(const keyrecord_t *record) {
+    uint16_t keycode = record->keycode;
+    bool pressed = record->event.pressed;
+
+    if (IS_QK_MOD_TAP(keycode)) {
+        if (record->tap.count) {
+            sim_send_key(QK_MOD_TAP_GET_TAP_KEYCODE(keycode), pressed);
+        }
+        else if (pressed) {
+            register_mods(mod_mask(keycode));
+        }
+        else {
+            unregister_mods(mod_mask(keycode));
+        }
+    }
+    else if (IS_QK_LAYER_TAP(keycode)) {
+        // layers aren't modelled: traces log keycodes from the active layer
+        if (record->tap.count) {
+            sim_send_key(QK_LAYER_TAP_GET_TAP_KEYCODE(keycode), pressed);
+        }
+    }
+    else {
+        sim_send_key(keycode, pressed);
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Storage, Comms & Debugging
+//
+///////////////////////////////////////////////////////////////////////////////
+
+void eeconfig_read_user_datablock(void *data, uint32_t offset,
+                                  uint32_t length) {
+    if (offset + length <= sizeof(eeprom)) {
+        memcpy(data, &eeprom[offset], length);
+    }
+}
+
+void eeconfig_update_user_datablock(const void *data, uint32_t offset,
+                                    uint32_t length) {
+    if (offset + length <= sizeof(eeprom)) {
+        memcpy(&eeprom[offset], data, length);
+    }
+}
+
+void raw_hid_send(uint8_t *data, uint8_t length) {}
+
+int xprintf(const char *fmt, ...) {
+    if (!debug_output) return 0;
+    va_list args;
+    va_start(args, fmt);
+    fprintf(stderr, "%7lu ", (unsigned long)now);
+    int n = vfprintf(stderr, fmt, args);
+    va_end(args);
+    return n;
+}
+
+const char *get_keycode_string(uint16_t keycode) {
+    static char buffer[8];
+    snprintf(buffer, sizeof(buffer), "0x%04X", keycode);
+    return buffer;
+}
@@ -0,0 +1,72 @@
+/**
+ * sim_qmk.h
+ * 
+ * The simulated keyboard: clock, modifiers, key actions, host output and
+ * handedness.
+ */
+
+#pragma once
+#include "quantum.h"
+
+/**
+ * @brief Sets the simulated time
+ * 
+ * @param now time in ms since the start of the trace
+ */
+void sim_set_time(uint32_t now);
+
+
+/**
+ * @brief Simulated time, in ms since the start of the trace
+ */
+uint32_t sim_time(void);
+
+
+/**
+ * @brief Records the hand of a matrix position ('L', 'R' or '*')
+ */
+void sim_set_hand(keypos_t key, char hand);
+
+
+/**
+ * @brief Records the keycode at a matrix position, as on the layer it was
+ *        pressed on (for get_event_keycode())
+ */
+void sim_set_keycode(keypos_t key, uint16_t keycode);
+
+
+/**
+ * @brief Sends a basic keycode to the simulated host
+ * 
+ * Presses type a character (shifted by any active shift mods or Caps Lock);
+ * Backspace deletes the last one (unless raw).
+ */
+void sim_send_key(uint16_t keycode, bool pressed);
+
+
+/**
+ * @brief Text typed so far, NUL-terminated
+ */
+const char *sim_output(void);
+
+
+/**
+ * @brief Forgets the text typed so far
+ */
+void sim_output_clear(void);
+
+
+/**
+ * @brief Carries out a decided key event: types a tap, or holds a mod-tap's
+ *        mods (layers aren't modelled)
+ */
+void sim_key_action(const keyrecord_t *record);
+
+
+/**
+ * @brief Options
+ * 
+ * @param raw true to type Backspace as '\b', rather than applying it
+ * @param debug true to print Lightshift's debug output (to stderr)
+ */
+void sim_qmk_init(bool raw, bool debug);
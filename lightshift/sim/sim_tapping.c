@@ -0,0 +1,234 @@
+#include "sim_tapping.h"
+#include "sim_qmk.h"
+#include "sim_hooks.h"
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// State
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// the tap-hold key being decided, or the last one tapped
+static keyrecord_t tapping_key;
+static bool tapping = false;    // pressed, awaiting tap / hold decision
+static bool tapped = false;     // released as a tap; may yet repeat
+
+// events waiting on the decision
+#define WAITING_BUFFER_SIZE 8   // as QMK
+static keyrecord_t waiting[WAITING_BUFFER_SIZE];
+static uint8_t waiting_count = 0;
+static uint32_t overflows = 0;
+static bool report_overflows = true;
+
+static void handle(keyrecord_t *record);
+
+
+static bool is_tap_hold(uint16_t keycode) {
+    return IS_QK_MOD_TAP(keycode) || IS_QK_LAYER_TAP(keycode);
+}
+
+
+bool sim_tapping_pending(void) {
+    return tapping;
+}
+
+
+uint32_t sim_tapping_overflows(void) {
+    return overflows;
+}
+
+
+void sim_tapping_report_overflows(bool report) {
+    report_overflows = report;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Waiting Buffer
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Is the press of this key waiting?
+static bool press_waiting(keypos_t key) {
+    for (uint8_t i = 0; i < waiting_count; i++) {
+        if (waiting[i].event.pressed && KEYEQ(waiting[i].event.key, key)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+static void enqueue(const keyrecord_t *record) {
+    if (waiting_count == WAITING_BUFFER_SIZE) {
+        // as QMK: clear the keyboard, and forget the buffer & undecided key
+        if (report_overflows) {
+            fprintf(stderr, "%7lu waiting buffer overflow\n",
+                    (unsigned long)sim_time());
+        }
+        overflows++;
+        clear_keyboard();
+        waiting_count = 0;
+        tapping = false;
+        tapped = false;
+        return;
+    }
+    waiting[waiting_count++] = *record;
+}
+
+
+// Process waiting events in order (any may start a new decision, in which
+// case the events after it wait again)
+static void drain(void) {
+    keyrecord_t events[WAITING_BUFFER_SIZE];
+    uint8_t count = waiting_count;
+    memcpy(events, waiting, sizeof(keyrecord_t) * count);
+    waiting_count = 0;
+    for (uint8_t i = 0; i < count; i++) handle(&events[i]);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Decisions
+//
+///////////////////////////////////////////////////////////////////////////////
+
+static bool within_term(uint16_t time) {
+    return TIMER_DIFF_16(time, tapping_key.event.time)
+           < sim_hook_tapping_term(&tapping_key);
+}
+
+
+static void resolve_hold(void) {
+    tapping = false;
+    tapped = false;
+    tapping_key.tap.count = 0;
+    sim_process_record(&tapping_key);
+    drain();
+}
+
+
+static void resolve_tap(keyrecord_t *release) {
+    tapping = false;
+    tapped = true;
+    tapping_key.tap.count = 1;
+    sim_process_record(&tapping_key);
+    release->tap = tapping_key.tap;
+    sim_process_record(release);
+    tapping_key = *release;
+    drain();
+}
+
+
+// Handle a key event: decide it now, or make it wait
+static void handle(keyrecord_t *record) {
+    keyevent_t event = record->event;
+
+    if (tapping) {
+        if (within_term(event.time)) {
+            // released in time: a tap
+            if (!event.pressed && KEYEQ(event.key, tapping_key.event.key)) {
+                resolve_tap(record);
+                return;
+            }
+            // a key pressed before the tap-hold key is released at once
+            // (unless a plain modifier, which is kept till the decision)
+            if (!event.pressed && !press_waiting(event.key)
+                    && !IS_MODIFIER_KEYCODE(record->keycode)) {
+                sim_process_record(record);
+                return;
+            }
+            if (event.pressed) tapping_key.tap.interrupted = true;
+            enqueue(record);
+            return;
+        }
+        // term expired before this event: a hold (after which a buffered
+        // tap-hold key may be undecided in turn, so start again)
+        resolve_hold();
+        handle(record);
+        return;
+    }
+
+    if (tapped && KEYEQ(event.key, tapping_key.event.key)) {
+        // repeated tap: pressed again within the quick tap term
+        if (event.pressed
+                && TIMER_DIFF_16(event.time, tapping_key.event.time)
+                   < QUICK_TAP_TERM) {
+            record->tap.count = tapping_key.tap.count < 15
+                                ? tapping_key.tap.count + 1 : 15;
+            sim_process_record(record);
+            tapping_key = *record;
+            return;
+        }
+        // ...and its release
+        if (!event.pressed && tapping_key.event.pressed) {
+            record->tap = tapping_key.tap;
+            sim_process_record(record);
+            tapping_key = *record;
+            return;
+        }
+    }
+    // any other press ends the chance of a repeat
+    if (event.pressed) tapped = false;
+
+    // (the record's keycode, which pre_process_record may have rewritten,
+    //  as QMK does only with COMBO_ENABLE)
+    if (event.pressed && is_tap_hold(record->keycode)) {
+        tapping_key = *record;
+        tapping_key.tap.count = 0;
+        tapping_key.tap.interrupted = false;
+        tapping = true;
+        return;
+    }
+    sim_process_record(record);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Entry Points
+//
+///////////////////////////////////////////////////////////////////////////////
+
+void sim_tapping_event(keyrecord_t *record) {
+    handle(record);
+}
+
+
+void sim_tapping_tick(void) {
+    // keyboards scan every millisecond, so a hold is decided as soon as the
+    // term expires (buffered events may then start, and expire, more terms)
+    while (tapping && !within_term((uint16_t)sim_time())) {
+        uint32_t now = sim_time();
+        uint16_t term = sim_hook_tapping_term(&tapping_key);
+        uint32_t expiry = now - TIMER_DIFF_16((uint16_t)now,
+                                              tapping_key.event.time) + term;
+        sim_set_time(expiry);
+        resolve_hold();
+        sim_set_time(now);
+    }
+}
+
+
+bool sim_tapping_deadline(uint32_t *deadline) {
+    uint32_t now = sim_time();
+    uint16_t elapsed = TIMER_DIFF_16((uint16_t)now, tapping_key.event.time);
+    if (tapping) {
+        *deadline = now - elapsed + sim_hook_tapping_term(&tapping_key);
+        return true;
+    }
+    if (tapped && elapsed < QUICK_TAP_TERM) {
+        *deadline = now - elapsed + QUICK_TAP_TERM;
+        return true;
+    }
+    return false;
+}
+
+
+void sim_tapping_reset(void) {
+    tapping = false;
+    tapped = false;
+    waiting_count = 0;
+}
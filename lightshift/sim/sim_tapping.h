@@ -0,0 +1,79 @@
+/**
+ * sim_tapping.h
+ * 
+ * A model of QMK's tap-hold engine (quantum/action_tapping.c), with the
+ * options Lightshift runs under: no Permissive Hold, Hold On Other Key Press,
+ * Chordal Hold or Flow Tap on lightshift keys.
+ * 
+ * While a tap-hold key is undecided, later events wait in a buffer.  The key
+ * is a tap if released within get_tapping_term(), or a hold once the term
+ * expires; then the buffered events are processed in order.  Releasing a
+ * tapped key and pressing it again within QUICK_TAP_TERM repeats the tap.
+ */
+
+#pragma once
+#include "quantum.h"
+
+#ifndef QUICK_TAP_TERM
+    #define QUICK_TAP_TERM TAPPING_TERM
+#endif
+
+
+/**
+ * @brief Passes a physical key event (after pre_process_record) to the engine
+ */
+void sim_tapping_event(keyrecord_t *record);
+
+
+/**
+ * @brief Resolves any tap-hold key whose term has expired by the current
+ *        simulated time; call before each event, and at the end of a trace
+ */
+void sim_tapping_tick(void);
+
+
+/**
+ * @brief Is a tap-hold decision still pending?
+ */
+bool sim_tapping_pending(void);
+
+
+/**
+ * @brief Number of times the waiting buffer has overflowed
+ * 
+ * As in QMK, an overflow clears the keyboard, the buffer and the undecided
+ * key.
+ */
+uint32_t sim_tapping_overflows(void);
+
+
+/**
+ * @brief Report each overflow on stderr? (default: yes)
+ */
+void sim_tapping_report_overflows(bool report);
+
+
+/**
+ * @brief When does the next decision fall due, without any more key events?
+ * 
+ * @param deadline set to the time the pending tap-hold key becomes a hold,
+ *        or else the time a tapped key can no longer repeat
+ * 
+ * @return false if nothing falls due
+ */
+bool sim_tapping_deadline(uint32_t *deadline);
+
+
+/**
+ * @brief Forgets any pending decision, waiting events & tap to repeat
+ */
+void sim_tapping_reset(void);
+
+
+/**
+ * @brief Processes a decided key event: process_record hooks, then the key's
+ *        action (taps, mods & basic keycodes)
+ * 
+ * Defined by each program: sim_main.c and sim_explore.c.
+ */
+void sim_process_record(keyrecord_t *record);
@@ -0,0 +1,137 @@
+#include "sim_trace.h"
+#include <stdlib.h>
+
+#define MAX_LINE 512
+#define MAX_FIELDS 16
+
+enum { TIME, ROW, COL, HAND, KEYCODE, PRESSED, COLUMN_COUNT };
+static const char *column_names[COLUMN_COUNT] = {
+    "time", "row", "col", "hand", "keycode", "pressed",
+};
+
+
+// Splits a CSV line in place (quoted fields may contain commas); returns the
+// number of fields
+static int split(char *line, char *fields[MAX_FIELDS]) {
+    int count = 0;
+    char *p = line;
+    while (count < MAX_FIELDS) {
+        bool quoted = *p == '"';
+        if (quoted) p++;
+        fields[count++] = p;
+        while (*p && (quoted ? *p != '"' : (*p != ',' && *p != '\n'
+                                            && *p != '\r'))) {
+            p++;
+        }
+        if (quoted && *p == '"') *p++ = '\0';
+        if (*p != ',') {
+            *p = '\0';
+            break;
+        }
+        *p++ = '\0';
+    }
+    return count;
+}
+
+
+static bool parse_uint(const char *text, unsigned long max,
+                       unsigned long *value) {
+    char *end;
+    if (!*text) return false;
+    *value = strtoul(text, &end, 10);
+    return *end == '\0' && *value <= max;
+}
+
+
+bool sim_trace_read(const char *path, sim_trace_t *trace) {
+    FILE *file = strcmp(path, "-") == 0 ? stdin : fopen(path, "r");
+    if (!file) {
+        perror(path);
+        return false;
+    }
+
+    int columns[COLUMN_COUNT];
+    bool have_header = false;
+    size_t capacity = 0;
+    uint16_t last_time = 0;
+    char line[MAX_LINE];
+    char *fields[MAX_FIELDS];
+
+    trace->events = NULL;
+    trace->count = 0;
+
+    while (fgets(line, sizeof(line), file)) {
+        int count = split(line, fields);
+
+        // header: find the columns
+        if (!have_header) {
+            if (strcmp(fields[0], "seq") != 0
+                    && strcmp(fields[0], "time") != 0) {
+                continue; // console output before the log starts
+            }
+            for (int c = 0; c < COLUMN_COUNT; c++) {
+                columns[c] = -1;
+                for (int f = 0; f < count; f++) {
+                    if (strcmp(fields[f], column_names[c]) == 0) columns[c] = f;
+                }
+                if (columns[c] < 0 && c != HAND) {
+                    fprintf(stderr, "%s: no '%s' column\n", path,
+                            column_names[c]);
+                    return false;
+                }
+            }
+            have_header = true;
+            continue;
+        }
+
+        // event: skip anything that doesn't parse (e.g. other console output)
+        unsigned long time, row, col, keycode, pressed;
+        if (count <= columns[PRESSED] || count <= columns[KEYCODE]
+                || !parse_uint(fields[columns[TIME]], UINT16_MAX, &time)
+                || !parse_uint(fields[columns[ROW]], UINT8_MAX, &row)
+                || !parse_uint(fields[columns[COL]], UINT8_MAX, &col)
+                || !parse_uint(fields[columns[KEYCODE]], UINT16_MAX, &keycode)
+                || !parse_uint(fields[columns[PRESSED]], 1, &pressed)) {
+            continue;
+        }
+
+        if (trace->count == capacity) {
+            capacity = capacity ? capacity * 2 : 4096;
+            trace->events = realloc(trace->events,
+                                    capacity * sizeof(sim_event_t));
+            if (!trace->events) {
+                fprintf(stderr, "Out of memory\n");
+                return false;
+            }
+        }
+
+        // logged times are 16-bit, so unwrap them into a 32-bit clock
+        sim_event_t *event = &trace->events[trace->count];
+        event->time = trace->count == 0
+                      ? time
+                      : trace->events[trace->count - 1].time
+                        + TIMER_DIFF_16((uint16_t)time, last_time);
+        last_time = (uint16_t)time;
+        event->key.row = (uint8_t)row;
+        event->key.col = (uint8_t)col;
+        event->keycode = (uint16_t)keycode;
+        event->pressed = pressed;
+        event->hand = columns[HAND] >= 0 && count > columns[HAND]
+                      ? fields[columns[HAND]][0] : 0;
+        trace->count++;
+    }
+
+    if (file != stdin) fclose(file);
+    if (!have_header) {
+        fprintf(stderr, "%s: no CSV header found\n", path);
+        return false;
+    }
+    return true;
+}
+
+
+void sim_trace_free(sim_trace_t *trace) {
+    free(trace->events);
+    trace->events = NULL;
+    trace->count = 0;
+}
@@ -0,0 +1,42 @@
+/**
+ * sim_trace.h
+ * 
+ * Reads timestamped key event traces, in Lumberjack's CSV format
+ * (LUMBERJACK_CSV):
+ * 
+ *     seq,time,row,col,hand,half,keycode,name,delta,duration,pressed
+ * 
+ * Columns are found by name from the header, so only time, row, col,
+ * keycode and pressed are required (hand is used for handedness if present),
+ * and other console output mixed into a capture is skipped.
+ */
+
+#pragma once
+#include "quantum.h"
+
+typedef struct {
+    uint32_t time;      ///< ms, unwrapped from the logged 16-bit time
+    keypos_t key;
+    uint16_t keycode;   ///< keycode from the keymap, e.g. LSFT_T(KC_S)
+    bool pressed;
+    char hand;          ///< 'L', 'R', '*', or 0 if not logged
+} sim_event_t;
+
+typedef struct {
+    sim_event_t *events;
+    size_t count;
+} sim_trace_t;
+
+
+/**
+ * @brief Reads a trace
+ * 
+ * @param path CSV file, or "-" for stdin
+ * @param trace set to the events read (free with sim_trace_free())
+ * 
+ * @return true on success; false (with a message on stderr) on failure
+ */
+bool sim_trace_read(const char *path, sim_trace_t *trace);
+
+
+void sim_trace_free(sim_trace_t *trace);
@@ -0,0 +1,202 @@
+#!/usr/bin/env python3
+"""
+gen_bigram_terms.py - Lightshift bigram tapping term table generator
+
+Writes a C header with a table of tapping term adjustments for each
+(previous letter, shift key, side of next key) context, for Lightshift's
+LIGHTSHIFT_BIGRAMS option.
+
+The table can be generated from either:
+
+  a corpus of text (any file not ending .csv), in which case each context's
+  adjustment comes from how often it is a roll (shift key tapped, e.g. "st")
+  versus a shift (e.g. "sT").  Rolls lengthen the term, so they aren't
+  shifted by mistake; shifts shorten it, so they aren't missed.  A corpus
+  doesn't say which shift typed each capital, so a share of capitals
+  (--same-hand-share) is counted as typed with a same-hand shift, and the
+  rest with an opposite-hand shift.  Needs --left, to know which letters are
+  on the left hand.
+
+  a CSV file of explicit adjustments, one per line:
+      prev,shift,side,adjust_ms      e.g.   a,s,same,20
+  where prev is a letter (or "-" for any non-letter), shift is the shift
+  key's tap letter, side is "same" or "opposite", and adjust_ms is -128..127.
+
+Usage:
+    gen_bigram_terms.py <corpus.txt | table.csv> <output.h>
+                        --shifts LETTERS [--left LETTERS]
+                        [--max-adjust MS] [--min-count N]
+                        [--same-hand-share FRACTION]
+
+e.g.
+    gen_bigram_terms.py corpus.txt lightshift_bigrams.h \\
+                        --shifts se --left bldwvzqgxjnrtsc
+
+The output file is only rewritten if its content changes, so the build
+does not recompile Lightshift unnecessarily.
+
+Author: dave-thompson
+"""
+
+import argparse
+import csv
+import os
+import string
+import sys
+
+LETTERS = string.ascii_lowercase
+OTHER = 26                 # index for "not a letter"
+SIDES = ("same", "opposite")
+
+
+def letter_index(char):
+    char = char.lower()
+    return LETTERS.index(char) if char in LETTERS else OTHER
+
+
+###############################################################################
+#
+# Reading Adjustments
+#
+###############################################################################
+
+def empty_table(shifts):
+    return [[[0, 0] for _ in shifts] for _ in range(OTHER + 1)]
+
+
+def from_csv(path, shifts):
+    table = empty_table(shifts)
+    with open(path, encoding="utf-8") as f:
+        for line_no, row in enumerate(csv.reader(f), 1):
+            if not row or row[0].startswith("#"):
+                continue
+            try:
+                prev, shift, side, adjust = [c.strip() for c in row]
+                adjust = int(adjust)
+            except ValueError:
+                raise SystemExit("%s:%u: expected prev,shift,side,adjust_ms"
+                                 % (path, line_no))
+            if shift not in shifts or side not in SIDES \
+                    or not -128 <= adjust <= 127:
+                raise SystemExit("%s:%u: bad entry" % (path, line_no))
+            table[letter_index(prev)][shifts.index(shift)][
+                SIDES.index(side)] = adjust
+    return table
+
+
+def from_corpus(path, shifts, left, max_adjust, min_count, same_hand_share):
+    """Count rolls and shifts for each context, and turn them into terms."""
+    with open(path, encoding="utf-8", errors="ignore") as f:
+        text = f.read()
+
+    def hand(char):
+        return "L" if char.lower() in left else "R"
+
+    # rolls[prev][shift][side] and presses[...] (shifted next letters)
+    rolls = empty_table(shifts)
+    presses = empty_table(shifts)
+    for i in range(1, len(text) - 1):
+        prev, char, nxt = text[i - 1], text[i], text[i + 1]
+
+        # roll: shift key's letter, tapped, then another letter
+        if char in shifts and nxt.isalpha():
+            side = 0 if hand(char) == hand(nxt) else 1
+            rolls[letter_index(prev)][shifts.index(char)][side] += 1
+
+        # shift: a capital letter, shared between the shift keys on each
+        # side (the shift key was pressed after prev, then the capital's key;
+        # a key can't shift its own letter)
+        if char.isupper() and char.lower() in LETTERS:
+            for s, shift in enumerate(shifts):
+                if hand(shift) != hand(char):
+                    presses[letter_index(prev)][s][1] += 1 - same_hand_share
+                elif shift != char.lower():
+                    presses[letter_index(prev)][s][0] += same_hand_share
+
+    table = empty_table(shifts)
+    for p in range(OTHER + 1):
+        for s in range(len(shifts)):
+            for side in range(2):
+                r, c = rolls[p][s][side], presses[p][s][side]
+                if r + c < min_count:
+                    continue
+                table[p][s][side] = round(max_adjust * (r - c) / (r + c))
+    return table
+
+
+###############################################################################
+#
+# Writing the Header
+#
+###############################################################################
+
+def render(table, shifts, source):
+    lines = [
+        "// Generated by lightshift/tools/gen_bigram_terms.py from",
+        "// %s - do not edit" % os.path.basename(source),
+        "",
+        "#pragma once",
+        "",
+        "#define LIGHTSHIFT_BIGRAM_SHIFTS %u" % len(shifts),
+        "",
+        "// tap keycode of each shift key, in table order",
+        "static const uint16_t lightshift_bigram_shift_keycodes[] = {",
+    ]
+    lines += ["    KC_%s," % s.upper() for s in shifts]
+    lines += [
+        "};",
+        "",
+        "// term adjustment (ms) by [previous letter (a-z, other)][shift key]"
+        "[same side, opposite side]",
+        "static const int8_t lightshift_bigram_adjust[27]"
+        "[LIGHTSHIFT_BIGRAM_SHIFTS][2] PROGMEM = {",
+    ]
+    for p, row in enumerate(table):
+        label = LETTERS[p] if p < OTHER else "-"
+        cells = ", ".join("{%4d, %4d}" % tuple(pair) for pair in row)
+        lines.append("    {%s}, // %s" % (cells, label))
+    lines.append("};")
+    return "\n".join(lines) + "\n"
+
+
+def main(argv):
+    parser = argparse.ArgumentParser(usage=__doc__)
+    parser.add_argument("source")
+    parser.add_argument("output")
+    parser.add_argument("--shifts", required=True)
+    parser.add_argument("--left", default="")
+    parser.add_argument("--max-adjust", type=int, default=30)
+    parser.add_argument("--min-count", type=int, default=20)
+    parser.add_argument("--same-hand-share", type=float, default=0.25)
+    args = parser.parse_args(argv[1:])
+
+    shifts = args.shifts.lower()
+    if not shifts or any(c not in LETTERS for c in shifts):
+        raise SystemExit("--shifts must be the shift keys' tap letters")
+    if not 0 <= args.max_adjust <= 127:
+        raise SystemExit("--max-adjust must be 0..127")
+    if not 0 <= args.same_hand_share <= 1:
+        raise SystemExit("--same-hand-share must be 0..1")
+
+    if args.source.endswith(".csv"):
+        table = from_csv(args.source, shifts)
+    else:
+        if not args.left:
+            raise SystemExit("--left is needed to generate from a corpus")
+        table = from_corpus(args.source, shifts, args.left.lower(),
+                            args.max_adjust, args.min_count,
+                            args.same_hand_share)
+    content = render(table, shifts, args.source)
+
+    os.makedirs(os.path.dirname(os.path.abspath(args.output)), exist_ok=True)
+    if os.path.exists(args.output):
+        with open(args.output, encoding="utf-8") as f:
+            if f.read() == content:
+                return 0
+    with open(args.output, "w", encoding="utf-8") as f:
+        f.write(content)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
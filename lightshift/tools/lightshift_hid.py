@@ -0,0 +1,172 @@
+#!/usr/bin/env python3
+"""
+lightshift_hid.py - Lightshift term profile tool (Linux)
+
+Reads and writes Lightshift's per-key tapping term profiles over raw HID,
+while the keyboard is running, so terms can be tuned without reflashing.
+Needs LIGHTSHIFT_PROFILES in config.h and RAW_ENABLE = yes in rules.mk.
+
+Talks to /dev/hidraw* directly (no libraries needed); you may need a udev
+rule, or sudo, for write access to the device.
+
+Usage:
+    lightshift_hid.py [--device /dev/hidrawN] info
+    lightshift_hid.py [--device ...] show
+    lightshift_hid.py [--device ...] profile N TERM EXTENDED_TERM
+    lightshift_hid.py [--device ...] key ROW COL N
+    lightshift_hid.py [--device ...] save
+
+e.g. give the pinky shifts (row 2, cols 0 & 11) a longer term:
+    lightshift_hid.py profile 1 140 400
+    lightshift_hid.py key 2 0 1
+    lightshift_hid.py key 2 11 1
+    lightshift_hid.py save
+
+Profile 0 is the global terms; a term of 0 in any profile also means "use
+the global term".  Changes apply immediately, but are lost at power off
+unless saved.
+
+Author: dave-thompson
+"""
+
+import argparse
+import glob
+import os
+import select
+import struct
+import sys
+
+REPORT_SIZE = 32
+LIGHTSHIFT_HID_ID = 0x4C
+RAW_USAGE_PAGE = b"\x06\x60\xff"   # QMK raw HID: usage page 0xFF60
+
+CMD_GET_INFO, CMD_GET_PROFILE, CMD_SET_PROFILE = 1, 2, 3
+CMD_GET_MAP, CMD_SET_KEY, CMD_SAVE = 4, 5, 6
+MAX_MAP_CHUNK = 28
+TIMEOUT = 1.0   # seconds to wait for each reply
+
+
+###############################################################################
+#
+# Device Access
+#
+###############################################################################
+
+def find_device():
+    """First hidraw device with QMK's raw HID usage page."""
+    for path in sorted(glob.glob("/sys/class/hidraw/hidraw*")):
+        try:
+            with open(os.path.join(path, "device/report_descriptor"),
+                      "rb") as f:
+                if RAW_USAGE_PAGE in f.read():
+                    return "/dev/" + os.path.basename(path)
+        except OSError:
+            continue
+    return None
+
+
+class Keyboard:
+    def __init__(self, path):
+        self.fd = os.open(path, os.O_RDWR)
+
+    def command(self, command, *args):
+        """Send a command; return its reply data, or raise on error."""
+        report = bytes([LIGHTSHIFT_HID_ID, command] + list(args))
+        # leading 0: report id
+        os.write(self.fd, b"\x00" + report.ljust(REPORT_SIZE, b"\x00"))
+        while True:
+            # (other raw HID reports may arrive first; skip them)
+            if not select.select([self.fd], [], [], TIMEOUT)[0]:
+                raise RuntimeError("no reply from keyboard to command %u "
+                                   "(is LIGHTSHIFT_PROFILES enabled?)"
+                                   % command)
+            reply = os.read(self.fd, REPORT_SIZE)
+            if reply[0] == LIGHTSHIFT_HID_ID and reply[1] == command:
+                break
+        if reply[2] != 0:
+            raise RuntimeError("keyboard rejected command %u %s"
+                               % (command, list(args)))
+        return reply[3:]
+
+
+###############################################################################
+#
+# Commands
+#
+###############################################################################
+
+def info(keyboard):
+    version, rows, cols, count = keyboard.command(CMD_GET_INFO)[:4]
+    return {"version": version, "rows": rows, "cols": cols, "count": count}
+
+
+def show(keyboard):
+    details = info(keyboard)
+    rows, cols, count = details["rows"], details["cols"], details["count"]
+
+    print("Profile   Term   Extended")
+    for profile in range(count):
+        term, extended = struct.unpack(
+            "<HH", keyboard.command(CMD_GET_PROFILE, profile)[:4])
+        if profile == 0:
+            print("   0     global   global")
+        else:
+            print("  %2u     %6s   %6s" % (profile, term or "global",
+                                          extended or "global"))
+
+    size = ((rows * cols + 3) // 4) * 2
+    packed = b""
+    while len(packed) < size:
+        packed += keyboard.command(CMD_GET_MAP, len(packed))[:MAX_MAP_CHUNK]
+    print("\nProfile per key (row x col):")
+    for row in range(rows):
+        line = []
+        for col in range(cols):
+            i = row * cols + col
+            line.append("%x" % ((packed[i >> 1] >> ((i & 1) * 4)) & 0x0F))
+        print("  " + " ".join(line))
+
+
+def main(argv):
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[1])
+    parser.add_argument("--device", help="hidraw device, e.g. /dev/hidraw3")
+    sub = parser.add_subparsers(dest="command", required=True)
+    sub.add_parser("info")
+    sub.add_parser("show")
+    profile = sub.add_parser("profile")
+    profile.add_argument("profile", type=int)
+    profile.add_argument("term", type=int)
+    profile.add_argument("extended", type=int)
+    key = sub.add_parser("key")
+    key.add_argument("row", type=int)
+    key.add_argument("col", type=int)
+    key.add_argument("profile", type=int)
+    sub.add_parser("save")
+    args = parser.parse_args(argv[1:])
+
+    path = args.device or find_device()
+    if not path:
+        sys.stderr.write("No raw HID keyboard found\n")
+        return 1
+    keyboard = Keyboard(path)
+
+    try:
+        if args.command == "info":
+            print(" ".join("%s=%u" % item for item in info(keyboard).items()))
+        elif args.command == "show":
+            show(keyboard)
+        elif args.command == "profile":
+            keyboard.command(CMD_SET_PROFILE, args.profile,
+                             *struct.pack("<HH", args.term, args.extended))
+        elif args.command == "key":
+            keyboard.command(CMD_SET_KEY, args.row, args.col, args.profile)
+        elif args.command == "save":
+            keyboard.command(CMD_SAVE)
+    except RuntimeError as error:
+        sys.stderr.write("%s\n" % error)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -6,6 +6,9 @@
 #include "lumberjack_config.h"
 #include "lumberjack_tracking.h"
 #include "lumberjack_logging.h"
+#include "lumberjack_burst.h"
+#include "lumberjack_filter.h"
+#include "lumberjack_split.h"
 
 ///////////////////////////////////////////////////////////////////////////////
 //
@@ -16,15 +19,24 @@
 typedef struct {
     bool active;                // has there been a keypress in last 60 secs?
     uint16_t last_event_time;   // time of last key event
+    bool last_event_remote;     // did last key event cross the split?
 } lumberjack_state_t;
 
 static lumberjack_state_t state = {0};
 
 
-// Update state if newly idle (60 seconds from last key event)
+// Update state if newly idle (60 seconds from last key event), and
+// summarise the burst once typing pauses (no keys held, brief idle time)
 static void update_state_if_idle(void) {
     if (state.active) {
         uint16_t idle_time = timer_read() - state.last_event_time;
+        if (lumberjack_bursts() && lumberjack_burst()->events > 0
+                && idle_time > LUMBERJACK_BURST_IDLE_TIME
+                && lumberjack_num_tracked_keys() == 0) {
+            lumberjack_log_burst(lumberjack_burst(),
+                                 lumberjack_burst_mean_delta());
+            lumberjack_burst_reset();
+        }
         if (idle_time > LUMBERJACK_MAX_DELTA) state.active = false;
     }
 }
@@ -46,7 +58,7 @@ static void update_state_if_idle(void) {
 bool pre_process_record_lumberjack(uint16_t current_keycode,
                                    keyrecord_t *record) {
 
-    // track keypress
+    // track keypress (filtered or not, so hold times and deltas stay right)
     keypress_t keypress_data = lumberjack_track_key(current_keycode, record);
 
     // choose keycode to be logged
@@ -71,9 +83,27 @@ bool pre_process_record_lumberjack(uint16_t current_keycode,
         state.active = true;
     }
 
-    // log physical key event
-    lumberjack_log_input(&keypress_data, log_keycode, delta,
-                         record->event.pressed);
+    // flag (and optionally correct) deltas between the halves of a split
+    // keyboard, which are skewed by the split transport's latency
+    bool remote = lumberjack_is_remote(record->event.key);
+    bool cross_half = delta != UINT16_MAX && remote != state.last_event_remote;
+    delta = lumberjack_split_correct_delta(delta, state.last_event_remote,
+                                           remote);
+    state.last_event_remote = remote;
+
+    // add event to the burst summary
+    if (lumberjack_bursts()) {
+        lumberjack_burst_add_event(delta, record->event.pressed,
+                                   keypress_data.keycode != 0,
+                                   lumberjack_num_tracked_keys());
+    }
+
+    // log physical key event (filtered events skip all formatting work)
+    if (!lumberjack_bursts_only()
+            && lumberjack_filter_passes(log_keycode, record)) {
+        lumberjack_log_input(&keypress_data, log_keycode, delta, cross_half,
+                             record);
+    }
 
     return true;
 }
@@ -90,11 +120,24 @@ bool process_record_lumberjack(uint16_t current_keycode,
                                keyrecord_t *record) {
 
     #ifdef LUMBERJACK_PR
-        lumberjack_log_interpreted_event("PR", current_keycode, record);
+        if (lumberjack_filter_passes(current_keycode, record)) {
+            lumberjack_log_interpreted_event("PR", current_keycode, record);
+        }
     #endif
 
+    // count mod-tap holds for the burst summary
+    if (lumberjack_bursts() && IS_QK_MOD_TAP(current_keycode)
+            && record->event.pressed && record->tap.count == 0) {
+        lumberjack_burst_add_mod_tap_hold();
+    }
+
     // if this is a lumberj key, toggle logging
-    return !lumberjack_toggle_if_lumberj_key(current_keycode, record);
+    if (lumberjack_toggle_if_lumberj_key(current_keycode, record)) {
+        return false;
+    }
+
+    // if this is a lumberj_filter key, toggle filtering
+    return !lumberjack_toggle_filter_if_filter_key(current_keycode, record);
 }
 
 
@@ -102,7 +145,9 @@ bool process_record_lumberjack(uint16_t current_keycode,
 void post_process_record_lumberjack(uint16_t current_keycode,
                                     keyrecord_t *record) {
     #ifdef LUMBERJACK_PPR
-        lumberjack_log_interpreted_event("PPR", current_keycode, record);
+        if (lumberjack_filter_passes(current_keycode, record)) {
+            lumberjack_log_interpreted_event("PPR", current_keycode, record);
+        }
     #endif
 }
 
@@ -115,11 +160,15 @@ void post_process_record_lumberjack(uint16_t current_keycode,
 
 void keyboard_post_init_lumberjack(void) {
     lumberjack_init_colors();
+    lumberjack_split_init();
 }
 
 
 void housekeeping_task_lumberjack(void) {
     update_state_if_idle();
+    if (lumberjack_split_task()) {
+        lumberjack_log_split_latency(lumberjack_split_latency_x16());
+    }
 }
 
 
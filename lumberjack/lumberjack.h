@@ -7,3 +7,4 @@
 #pragma once
 
 #include "lumberjack_config.h"
+#include "lumberjack_filter.h"
@@ -0,0 +1,50 @@
+#include "lumberjack_burst.h"
+
+
+// State
+static lumberjack_burst_t burst = {0};
+
+
+// Adds a key event to the running totals
+void lumberjack_burst_add_event(uint16_t delta, bool pressed, bool tracked,
+                                uint8_t num_held) {
+
+    // deltas only count within a burst (the first event's delta is the idle
+    // gap since the previous burst)
+    if (burst.events > 0 && delta != UINT16_MAX) {
+        burst.duration += delta;
+        if (delta > burst.max_delta) burst.max_delta = delta;
+    }
+
+    // saturate counters rather than wrap
+    if (burst.events < UINT16_MAX) burst.events++;
+    if (pressed && burst.presses < UINT16_MAX) burst.presses++;
+    if (!tracked && burst.untracked < UINT16_MAX) burst.untracked++;
+
+    if (num_held > burst.max_simultaneous) burst.max_simultaneous = num_held;
+}
+
+
+// Counts a mod-tap hold
+void lumberjack_burst_add_mod_tap_hold(void) {
+    if (burst.mod_tap_holds < UINT16_MAX) burst.mod_tap_holds++;
+}
+
+
+// Returns the running totals
+const lumberjack_burst_t* lumberjack_burst(void) {
+    return &burst;
+}
+
+
+// Returns the mean delta, or 0 if there are no deltas yet
+uint16_t lumberjack_burst_mean_delta(void) {
+    if (burst.events < 2) return 0;
+    return (uint16_t)(burst.duration / (burst.events - 1));
+}
+
+
+// Clears the running totals
+void lumberjack_burst_reset(void) {
+    burst = (lumberjack_burst_t){0};
+}
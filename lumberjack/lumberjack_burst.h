@@ -0,0 +1,86 @@
+/**
+ * @file lumberjack_burst.h
+ * @brief Running aggregates for a burst of typing
+ *
+ * A burst is a run of key events with no idle gap between them.  This
+ * library keeps cheap running totals for the current burst, so that a
+ * one-line summary can be logged once the burst goes idle, instead of (or as
+ * well as) a line for every key event.
+ *
+ * Call lumberjack_burst_add_event() for every key event, and
+ * lumberjack_burst_add_mod_tap_hold() whenever a mod-tap resolves to a hold.
+ * Read the totals with lumberjack_burst(), then call lumberjack_burst_reset()
+ * to begin the next burst.
+ *
+ * @author dave-thompson
+ */
+
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * @brief Running aggregates for the current burst
+ */
+typedef struct {
+    uint16_t events;            // key events (DOWN and UP) in the burst
+    uint16_t presses;           // key presses (DOWN only) in the burst
+    uint16_t untracked;         // key events which could not be tracked
+    uint16_t mod_tap_holds;     // mod-taps which resolved to holds
+    uint16_t max_delta;         // longest delta between two events
+    uint32_t duration;          // time from first to last event (= sum of
+                                // deltas, so never overflows mid-burst)
+    uint8_t max_simultaneous;   // most keys held down at the same time
+} lumberjack_burst_t;
+
+
+/**
+ * @brief Add a key event to the current burst
+ *
+ * @param delta milliseconds since the preceeding key event (UINT16_MAX for
+ *              no delta); ignored for the first event of a burst
+ * @param pressed true for DOWN, false for UP
+ * @param tracked true if the event has tracking data, otherwise false
+ * @param num_held number of keys held down after this event
+ */
+void lumberjack_burst_add_event(uint16_t delta, bool pressed, bool tracked,
+                                uint8_t num_held);
+
+
+/**
+ * @brief Record that a mod-tap resolved to a hold during the current burst
+ */
+void lumberjack_burst_add_mod_tap_hold(void);
+
+
+/**
+ * @brief Get the aggregates for the current burst
+ *
+ * @return pointer to the current burst's aggregates
+ */
+const lumberjack_burst_t* lumberjack_burst(void);
+
+
+/**
+ * @brief Mean delta between events in the current burst
+ *
+ * @return mean delta in milliseconds, or 0 if the burst has fewer than two
+ *         events
+ */
+uint16_t lumberjack_burst_mean_delta(void);
+
+
+/**
+ * @brief Reset the aggregates, ready for the next burst
+ */
+void lumberjack_burst_reset(void);
+
+
+#ifdef __cplusplus
+}
+#endif
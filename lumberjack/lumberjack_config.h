@@ -25,6 +25,21 @@
 
 #define LUMBERJACK_MAX_DELTA 60000 // before wraparound at 65536ms
 
+#ifndef LUMBERJACK_BURST_IDLE_TIME
+    #define LUMBERJACK_BURST_IDLE_TIME 1000 // typing pause that ends a burst
+#endif
+#if LUMBERJACK_BURST_IDLE_TIME > LUMBERJACK_MAX_DELTA
+    #error "LUMBERJACK_BURST_IDLE_TIME must be no more than 60,000ms"
+#endif
+
+#if defined(LUMBERJACK_SPLIT_CORRECT) && !defined(LUMBERJACK_SPLIT_LATENCY)
+    #error "LUMBERJACK_SPLIT_CORRECT requires LUMBERJACK_SPLIT_LATENCY"
+#endif
+
+#if defined(LUMBERJACK_CSV) && defined(LUMBERJACK_JSON)
+    #error "Choose one of LUMBERJACK_CSV and LUMBERJACK_JSON"
+#endif
+
 
 ///////////////////////////////////////////////////////////////////////////////
 //
@@ -44,6 +59,64 @@ inline bool lumberjack_color(void) {
 }
 
 
+/**
+ * @brief Convenience method for access to LUMBERJACK_BURSTS config parameter
+ * 
+ * @return true if burst summaries should be logged (LUMBERJACK_BURSTS or
+ *         LUMBERJACK_BURSTS_ONLY)
+ */
+inline bool lumberjack_bursts(void) {
+    #if defined(LUMBERJACK_BURSTS) || defined(LUMBERJACK_BURSTS_ONLY)
+        return true;
+    #else
+        return false;
+    #endif
+}
+
+
+/**
+ * @brief Convenience method for access to LUMBERJACK_BURSTS_ONLY parameter
+ * 
+ * @return true if individual key events should NOT be logged (only burst
+ *         summaries)
+ */
+inline bool lumberjack_bursts_only(void) {
+    #ifdef LUMBERJACK_BURSTS_ONLY
+        return true;
+    #else
+        return false;
+    #endif
+}
+
+
+/**
+ * @brief Convenience method for access to LUMBERJACK_CSV config parameter
+ * 
+ * @return true if key events should be logged as CSV lines
+ */
+inline bool lumberjack_csv(void) {
+    #ifdef LUMBERJACK_CSV
+        return true;
+    #else
+        return false;
+    #endif
+}
+
+
+/**
+ * @brief Convenience method for access to LUMBERJACK_JSON config parameter
+ * 
+ * @return true if key events should be logged as JSON lines
+ */
+inline bool lumberjack_json(void) {
+    #ifdef LUMBERJACK_JSON
+        return true;
+    #else
+        return false;
+    #endif
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////
 //
 // Runtime Config
@@ -0,0 +1,148 @@
+#include "quantum.h"
+#include "lumberjack_filter.h"
+#include "lumberjack_logging.h"
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// State
+//
+///////////////////////////////////////////////////////////////////////////////
+
+typedef struct {
+    bool on;                // is the filter applied?
+    uint8_t first_row;      // matrix block to be logged (inclusive)
+    uint8_t last_row;
+    uint8_t first_col;
+    uint8_t last_col;
+    uint8_t keycodes;       // LUMBERJACK_MOD_TAPS, etc.
+    uint8_t hands;          // LUMBERJACK_LEFT_HAND, etc.
+    uint8_t events;         // LUMBERJACK_DOWN, LUMBERJACK_UP
+    layer_state_t layers;   // layers to be logged
+} lumberjack_filter_t;
+
+// Filter that lets everything through
+#define NO_FILTER (lumberjack_filter_t){                                    \
+    .on = false,                                                            \
+    .first_row = 0, .last_row = UINT8_MAX,                                  \
+    .first_col = 0, .last_col = UINT8_MAX,                                  \
+    .keycodes = LUMBERJACK_ALL_KEYS,                                        \
+    .hands = LUMBERJACK_ALL_HANDS,                                          \
+    .events = LUMBERJACK_ALL_EVENTS,                                        \
+    .layers = (layer_state_t)~0,                                            \
+}
+
+static lumberjack_filter_t filter = NO_FILTER;
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Setting the Filter
+//
+///////////////////////////////////////////////////////////////////////////////
+
+void lumberjack_filter_positions(uint8_t first_row, uint8_t last_row,
+                                 uint8_t first_col, uint8_t last_col) {
+    filter.first_row = first_row;
+    filter.last_row = last_row;
+    filter.first_col = first_col;
+    filter.last_col = last_col;
+    filter.on = true;
+}
+
+void lumberjack_filter_keycodes(uint8_t classes) {
+    filter.keycodes = classes;
+    filter.on = true;
+}
+
+void lumberjack_filter_layers(layer_state_t layers) {
+    filter.layers = layers;
+    filter.on = true;
+}
+
+void lumberjack_filter_hands(uint8_t hands) {
+    filter.hands = hands;
+    filter.on = true;
+}
+
+void lumberjack_filter_events(uint8_t events) {
+    filter.events = events;
+    filter.on = true;
+}
+
+void lumberjack_filter_reset(void) {
+    filter = NO_FILTER;
+}
+
+void lumberjack_filter_toggle(void) {
+    filter.on = !filter.on;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Applying the Filter
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Returns the LUMBERJACK_* class flag for a keycode
+static uint8_t keycode_class(uint16_t keycode) {
+    if (IS_QK_MOD_TAP(keycode)) return LUMBERJACK_MOD_TAPS;
+    if (IS_QK_LAYER_TAP(keycode)) return LUMBERJACK_LAYER_TAPS;
+    if (keycode >= KC_A && keycode <= KC_Z) return LUMBERJACK_LETTERS;
+    return LUMBERJACK_OTHER_KEYS;
+}
+
+
+// Returns the LUMBERJACK_* hand flag for a key position
+static uint8_t hand_class(keypos_t key) {
+    switch (handedness(key)) {
+        case 'L': return LUMBERJACK_LEFT_HAND;
+        case 'R': return LUMBERJACK_RIGHT_HAND;
+        default:  return LUMBERJACK_OTHER_HAND;
+    }
+}
+
+
+// Should this event be logged?
+// Cheapest checks first; handedness (potentially a PROGMEM lookup) is only
+// computed when a hand filter is actually set
+bool lumberjack_filter_passes(uint16_t keycode, const keyrecord_t *record) {
+    if (!filter.on) return true;
+
+    const keypos_t key = record->event.key;
+    const uint8_t event = record->event.pressed ? LUMBERJACK_DOWN
+                                                : LUMBERJACK_UP;
+
+    if (!(filter.events & event)) return false;
+
+    if (key.row < filter.first_row || key.row > filter.last_row
+        || key.col < filter.first_col || key.col > filter.last_col) {
+        return false;
+    }
+
+    if (!(filter.keycodes & keycode_class(keycode))) return false;
+
+    if (filter.layers != (layer_state_t)~0) {
+        uint8_t layer = get_highest_layer(layer_state | default_layer_state);
+        if (!(filter.layers & ((layer_state_t)1 << layer))) return false;
+    }
+
+    if (filter.hands != LUMBERJACK_ALL_HANDS) {
+        if (!(filter.hands & hand_class(key))) return false;
+    }
+
+    return true;
+}
+
+
+// Toggle filter when LUMBERJ_FILTER key pressed
+bool lumberjack_toggle_filter_if_filter_key(uint16_t current_keycode,
+                                            const keyrecord_t *record) {
+    if (current_keycode == LUMBERJ_FILTER) {
+        if (record->event.pressed) {
+            lumberjack_filter_toggle();
+        }
+        return true;
+    }
+    return false;
+}
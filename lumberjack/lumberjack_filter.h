@@ -0,0 +1,154 @@
+/**
+ * @file lumberjack_filter.h
+ *
+ * @brief Runtime filter deciding which key events Lumberjack logs
+ *
+ * Filtered events are still tracked and timed (so hold times, deltas and
+ * burst summaries count them), but the filter is checked before any
+ * formatting work is done, so they cost little.  By default, no filter is set and
+ * every key event is logged.
+ *
+ * Set up a filter by calling any of the lumberjack_filter_*() functions below
+ * (e.g. from keyboard_post_init_user()).  Each call narrows the filter
+ * further and switches it on.  An event is logged only if it passes every
+ * part of the filter.  Use a LUMBERJ_FILTER key to switch the filter off
+ * and on again at runtime.
+ *
+ * @code
+ * void keyboard_post_init_user(void) {
+ *     // log only mod-taps on the home row (row 1) of the left hand
+ *     lumberjack_filter_keycodes(LUMBERJACK_MOD_TAPS);
+ *     lumberjack_filter_positions(1, 1, 0, MATRIX_COLS - 1);
+ *     lumberjack_filter_hands(LUMBERJACK_LEFT_HAND);
+ * }
+ * @endcode
+ *
+ * @author dave-thompson
+ */
+
+#pragma once
+
+#include "quantum.h"
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Filter Flags
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Keycode classes, for lumberjack_filter_keycodes()
+#define LUMBERJACK_MOD_TAPS     0x01 // mod-taps, e.g. LSFT_T(KC_S)
+#define LUMBERJACK_LAYER_TAPS   0x02 // layer-taps, e.g. LT(1, KC_SPC)
+#define LUMBERJACK_LETTERS      0x04 // KC_A to KC_Z
+#define LUMBERJACK_OTHER_KEYS   0x08 // everything else
+#define LUMBERJACK_ALL_KEYS     0x0F
+
+// Hands, for lumberjack_filter_hands()
+#define LUMBERJACK_LEFT_HAND    0x01 // 'L'
+#define LUMBERJACK_RIGHT_HAND   0x02 // 'R'
+#define LUMBERJACK_OTHER_HAND   0x04 // '*' or unknown
+#define LUMBERJACK_ALL_HANDS    0x07
+
+// Event types, for lumberjack_filter_events()
+#define LUMBERJACK_DOWN         0x01 // key presses
+#define LUMBERJACK_UP           0x02 // key releases
+#define LUMBERJACK_ALL_EVENTS   0x03
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Setting the Filter
+//
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Log only keys within a block of the matrix (inclusive)
+ *
+ * @param first_row first matrix row to be logged
+ * @param last_row last matrix row to be logged
+ * @param first_col first matrix column to be logged
+ * @param last_col last matrix column to be logged
+ */
+void lumberjack_filter_positions(uint8_t first_row, uint8_t last_row,
+                                 uint8_t first_col, uint8_t last_col);
+
+
+/**
+ * @brief Log only keycodes of the given classes
+ *
+ * @param classes bitwise OR of LUMBERJACK_MOD_TAPS, LUMBERJACK_LAYER_TAPS,
+ *                LUMBERJACK_LETTERS and LUMBERJACK_OTHER_KEYS
+ */
+void lumberjack_filter_keycodes(uint8_t classes);
+
+
+/**
+ * @brief Log only events while the highest active layer is one of the given
+ *        layers
+ *
+ * @param layers layer bitmask, e.g. (1 << 0) | (1 << 2) for layers 0 and 2
+ */
+void lumberjack_filter_layers(layer_state_t layers);
+
+
+/**
+ * @brief Log only keys for the given hands
+ *
+ * @param hands bitwise OR of LUMBERJACK_LEFT_HAND, LUMBERJACK_RIGHT_HAND and
+ *              LUMBERJACK_OTHER_HAND
+ *
+ * @note handedness is only known when Lightshift or Chordal Hold is in use
+ */
+void lumberjack_filter_hands(uint8_t hands);
+
+
+/**
+ * @brief Log only presses, or only releases
+ *
+ * @param events LUMBERJACK_DOWN, LUMBERJACK_UP or both
+ */
+void lumberjack_filter_events(uint8_t events);
+
+
+/**
+ * @brief Remove all filtering, so every event is logged
+ */
+void lumberjack_filter_reset(void);
+
+
+/**
+ * @brief Switch the filter on / off, keeping its settings
+ */
+void lumberjack_filter_toggle(void);
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Applying the Filter
+//
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Should this key event be logged?
+ *
+ * @param keycode keycode for the key event
+ * @param record record for the key event
+ *
+ * @return true if the event passes the filter (or no filter is on)
+ */
+bool lumberjack_filter_passes(uint16_t keycode, const keyrecord_t *record);
+
+
+/**
+ * @brief Toggles the filter when LUMBERJ_FILTER key pressed
+ *
+ * Takes no action if passed keycode is not LUMBERJ_FILTER, or if key was
+ * released rather than pressed.
+ *
+ * @param current_keycode keycode currently being processed
+ * @param *record record currently being processed
+ *
+ * @return true if keycode was LUMBERJ_FILTER, otherwise false
+ */
+bool lumberjack_toggle_filter_if_filter_key(uint16_t current_keycode,
+                                            const keyrecord_t *record);
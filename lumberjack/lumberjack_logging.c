@@ -1,6 +1,9 @@
 #include "lumberjack_utils.h"
 #include "lumberjack_config.h"
 #include "lumberjack_tracking.h"
+#include "lumberjack_burst.h"
+#include "lumberjack_names.h"
+#include "lumberjack_split.h"
 
 ///////////////////////////////////////////////////////////////////////////////
 //
@@ -58,13 +61,13 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 char chordal_hold_handedness(keypos_t key);
-char lightshift_handedness(keypos_t key);
+char lightshift_cached_handedness(keypos_t key);
 
 // Return either lightshift or chordal hold's handedness, or '?' if neither
 // in use
 char handedness(keypos_t key) {
     #ifdef LIGHTSHIFT_ENABLE
-        return lightshift_handedness(key);
+        return lightshift_cached_handedness(key);
     #elifdef CHORDAL_HOLD
         return chordal_hold_handedness(key);
     #endif
@@ -109,10 +112,100 @@ static void prettify_handedness(char* dest, char handedness) {
 }
 
 
+#ifdef LUMBERJACK_KEYCODE_NAMES
+
+    // table of names for the keymap's keycodes, generated at build time by
+    // tools/gen_keycode_names.py (see rules.mk)
+    #include "lumberjack_keycode_names.h"
+
+    static const lumberjack_names_t keycode_names = {
+        lumberjack_name_keycodes,
+        lumberjack_name_offsets,
+        LUMBERJACK_NAMES_COUNT,
+        lumberjack_name_pool,
+        lumberjack_name_dict,
+        lumberjack_name_dict_offsets,
+    };
+
+    // Append mod-tap prefix to dest, e.g. "LSFT_T(" or "LCS_T("
+    static void append_mod_tap_prefix(char* dest, uint8_t mods_5bit) {
+        static const char* const single_mods[] = {"CTL", "SFT", "ALT", "GUI"};
+        static const char multi_mods[] = "CSAG";
+
+        char prefix[8] = {0};
+        uint8_t len = 0;
+        prefix[len++] = (mods_5bit & 0x10) ? 'R' : 'L';
+
+        uint8_t mods = mods_5bit & 0x0F;
+        if ((mods & (mods - 1)) == 0) { // single mod, e.g. LSFT
+            for (uint8_t i = 0; i < 4; i++) {
+                if (mods == (1 << i)) {
+                    lumberjack_safe_copy(&prefix[len], 4, single_mods[i]);
+                    len += 3;
+                }
+            }
+        }
+        else { // multiple mods, e.g. LCS
+            for (uint8_t i = 0; i < 4; i++) {
+                if (mods & (1 << i)) prefix[len++] = multi_mods[i];
+            }
+        }
+        lumberjack_append_string(dest, MAX_KEYCODE_LEN, prefix);
+        lumberjack_append_string(dest, MAX_KEYCODE_LEN, "_T(");
+    }
+
+    // Get name from the generated table, composing mod-tap & layer-tap names
+    // from their parts; returns false if the keycode is not in the table
+    static bool name_keycode(char* dest, uint16_t keycode) {
+        dest[0] = '\0';
+
+        // whole keycode in table (incl. keymap aliases like HOME_A)
+        int16_t index = lumberjack_find_name(&keycode_names, keycode);
+        if (index >= 0) {
+            lumberjack_append_name(dest, MAX_KEYCODE_LEN, &keycode_names,
+                                   index);
+            return true;
+        }
+
+        // mod-tap, e.g. LSFT_T(KC_S)
+        if (IS_QK_MOD_TAP(keycode)) {
+            index = lumberjack_find_name(&keycode_names,
+                                         QK_MOD_TAP_GET_TAP_KEYCODE(keycode));
+            if (index < 0) return false;
+            append_mod_tap_prefix(dest, QK_MOD_TAP_GET_MODS(keycode));
+        }
+
+        // layer-tap, e.g. LT(1,KC_SPC)
+        else if (IS_QK_LAYER_TAP(keycode)) {
+            index = lumberjack_find_name(&keycode_names,
+                                       QK_LAYER_TAP_GET_TAP_KEYCODE(keycode));
+            if (index < 0) return false;
+            char layer[MAX_DELTA_LEN];
+            lumberjack_uint_to_string(layer, MAX_DELTA_LEN,
+                                      QK_LAYER_TAP_GET_LAYER(keycode));
+            lumberjack_append_string(dest, MAX_KEYCODE_LEN, "LT(");
+            lumberjack_append_string(dest, MAX_KEYCODE_LEN, layer);
+            lumberjack_append_string(dest, MAX_KEYCODE_LEN, ",");
+        }
+
+        else return false;
+
+        lumberjack_append_name(dest, MAX_KEYCODE_LEN, &keycode_names, index);
+        lumberjack_append_string(dest, MAX_KEYCODE_LEN, ")");
+        return true;
+    }
+
+#endif
+
+
 // Get human-readable string for a given keycode
 // (dest buffer must be at least MAX_KEYCODE_LEN chars)
 static void prettify_keycode(char* dest, uint16_t keycode) {
-    #ifdef KEYCODE_STRING_ENABLE
+    #if defined(LUMBERJACK_KEYCODE_NAMES)
+        if (!name_keycode(dest, keycode)) {
+            lumberjack_keycode_to_hex_string(dest, MAX_KEYCODE_LEN, keycode);
+        }
+    #elif defined(KEYCODE_STRING_ENABLE)
         lumberjack_safe_copy(dest, MAX_KEYCODE_LEN,
                              get_keycode_string(keycode));
     #else
@@ -140,16 +233,21 @@ static void prettify_handed_keycode(char* dest, char hand, uint16_t keycode) {
 }
 
 
-// Get right-aligned 5-char string for integer delta, e.g. "  243"
+// Get right-aligned 5-char string for integer delta, e.g. "  243", or
+// " ~243" if the delta crossed the halves of a split keyboard
 // (UINT16_MAX interpreted as no delta, returns "    -")
-static void prettify_delta(char* dest, uint16_t delta) {
+static void prettify_delta(char* dest, uint16_t delta, bool cross_half) {
     if (delta == UINT16_MAX) {
         strcpy(dest, "    -");
     }
     else {
-        char delta_string[MAX_DELTA_LEN];
-        lumberjack_uint_to_string(delta_string, MAX_DELTA_LEN, delta);
-        lumberjack_right_align_string(dest, MAX_DELTA_LEN, delta_string);
+        // (no room for the '~' beside 5 digits, where the flag is moot: any
+        //  split latency is lost in a 10 second delta)
+        char delta_string[MAX_DELTA_LEN + 1] = "~";
+        lumberjack_uint_to_string(&delta_string[1], MAX_DELTA_LEN, delta);
+        lumberjack_right_align_string(dest, MAX_DELTA_LEN,
+                                      cross_half && delta < 10000
+                                      ? delta_string : &delta_string[1]);
     }
 }
 
@@ -231,10 +329,97 @@ static void log_normally(const keypress_t* keypress_data,
 }
 
 
+///////////////////////////////////////////////////////////////////////////////
+//
+// Writing to Log (Structured, i.e. CSV & JSON Lines)
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Sequence number of the next structured line, so gaps (e.g. from a console
+// that dropped output) can be spotted
+static uint32_t structured_seq = 0;
+
+
+// Get decimal string for value, or empty_string if value is UINT16_MAX
+static void structured_uint(char* dest, uint16_t value,
+                            const char* empty_string) {
+    if (value == UINT16_MAX) {
+        lumberjack_safe_copy(dest, MAX_DELTA_LEN, empty_string);
+    }
+    else {
+        lumberjack_uint_to_string(dest, MAX_DELTA_LEN, value);
+    }
+}
+
+
+// Log a physical key event as one CSV or JSON line, with no padding, colour
+// or special cases (untracked presses simply have no duration)
+static void log_structured(const keypress_t* keypress_data, uint16_t keycode,
+                           uint16_t delta, const keyrecord_t* record) {
+    char keycode_string[MAX_KEYCODE_LEN];
+    prettify_keycode(keycode_string, keycode);
+
+    // duration is only known on release of a tracked key
+    uint16_t duration = UINT16_MAX;
+    if (!record->event.pressed && keypress_data->keycode != 0) {
+        duration = keypress_data->up_time - keypress_data->down_time;
+    }
+
+    // missing values are empty in CSV and null in JSON
+    const char* empty_string = lumberjack_json() ? "null" : "";
+    char delta_string[MAX_DELTA_LEN];
+    structured_uint(delta_string, delta, empty_string);
+    char duration_string[MAX_DELTA_LEN];
+    structured_uint(duration_string, duration, empty_string);
+
+    if (lumberjack_json()) {
+        lj_printf("{\"seq\":%lu,\"time\":%u,\"row\":%u,\"col\":%u,"
+                  "\"hand\":\"%c\",\"half\":\"%c\",\"keycode\":%u,"
+                  "\"name\":\"%s\",\"delta\":%s,\"duration\":%s,"
+                  "\"pressed\":%u}\n",
+                  (unsigned long)structured_seq, record->event.time,
+                  record->event.key.row, record->event.key.col,
+                  handedness(record->event.key),
+                  lumberjack_half(record->event.key), keycode, keycode_string,
+                  delta_string, duration_string, record->event.pressed);
+    }
+    else {
+        // header before the first line, so the log can be loaded as-is
+        if (structured_seq == 0) {
+            lj_printf("seq,time,row,col,hand,half,keycode,name,delta,"
+                      "duration,pressed\n");
+        }
+        // names are quoted, as some contain commas, e.g. LT(1,KC_SPC)
+        lj_printf("%lu,%u,%u,%u,%c,%c,%u,\"%s\",%s,%s,%u\n",
+                  (unsigned long)structured_seq, record->event.time,
+                  record->event.key.row, record->event.key.col,
+                  handedness(record->event.key),
+                  lumberjack_half(record->event.key), keycode, keycode_string,
+                  delta_string, duration_string, record->event.pressed);
+    }
+    structured_seq++;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Writing to Log (Pre-PR, Entry Point)
+//
+///////////////////////////////////////////////////////////////////////////////
+
 // Log a (pre-PR) physical key event (DOWN or UP) to the console
 void lumberjack_log_input(const keypress_t* keypress_data,
-                          uint16_t keycode, uint16_t delta,
-                          bool pressed) {
+                          uint16_t keycode, uint16_t delta, bool cross_half,
+                          const keyrecord_t* record) {
+
+    // skip all formatting work if logging is off
+    if (!lumberjack_is_logging()) return;
+
+    // structured output skips the pretty formatting entirely
+    if (lumberjack_csv() || lumberjack_json()) {
+        log_structured(keypress_data, keycode, delta, record);
+        return;
+    }
 
     // convert hand & keycode to pretty string
     char hand = handedness(keypress_data->key);
@@ -243,7 +428,7 @@ void lumberjack_log_input(const keypress_t* keypress_data,
 
     // convert delta to pretty string
     char delta_string[MAX_DELTA_LEN];
-    prettify_delta(delta_string, delta);
+    prettify_delta(delta_string, delta, cross_half);
 
     // if key press was not tracked, log warning
     if (keypress_data->keycode == 0) {
@@ -252,7 +437,8 @@ void lumberjack_log_input(const keypress_t* keypress_data,
     }
 
     // otherwise log normally
-    log_normally(keypress_data, keycode_string, delta_string, pressed);
+    log_normally(keypress_data, keycode_string, delta_string,
+                 record->event.pressed);
 }
 
 
@@ -266,6 +452,9 @@ void lumberjack_log_input(const keypress_t* keypress_data,
 void lumberjack_log_interpreted_event(const char *prefix, uint16_t keycode,
                                       keyrecord_t *record) {
 
+    // skip all formatting work if logging is off
+    if (!lumberjack_is_logging()) return;
+
     // convert keycode to pretty string
     char keycode_string[MAX_KEYCODE_LEN];
     prettify_keycode(keycode_string, keycode);
@@ -282,3 +471,37 @@ void lumberjack_log_interpreted_event(const char *prefix, uint16_t keycode,
               record->event.key.col,
               record->event.key.row);
 }
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Writing to Log (Burst Summaries)
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Log a one-line summary of a burst of typing
+void lumberjack_log_burst(const lumberjack_burst_t* burst,
+                          uint16_t mean_delta) {
+    lj_printf("BURST  Keys: %u  |  Time: %lu ms  |  Delta: %u avg, %u max  |"
+              "  Max Held: %u  |  MT Holds: %u  |  Not Tracked: %u\n",
+              burst->presses,
+              (unsigned long)burst->duration,
+              mean_delta,
+              burst->max_delta,
+              burst->max_simultaneous,
+              burst->mod_tap_holds,
+              burst->untracked);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Writing to Log (Split Keyboards)
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Log the split transport's estimated one-way latency, e.g. "1.3 ms"
+void lumberjack_log_split_latency(uint16_t latency_x16) {
+    lj_printf("SPLIT  Latency: %u.%u ms (one way, estimated)\n",
+              latency_x16 >> 4, ((latency_x16 & 0x0F) * 10) >> 4);
+}
@@ -7,19 +7,36 @@
 #pragma once
 
 #include "lumberjack_tracking.h"
+#include "lumberjack_burst.h"
+
+/**
+ * @brief Handedness of a key, from Lightshift or Chordal Hold
+ * 
+ * @param key key position
+ * 
+ * @return 'L', 'R', '*', or '?' if neither Lightshift nor Chordal Hold is in
+ *         use
+ */
+char handedness(keypos_t key);
+
 
 /**
  * @brief Log a physical key movement (DOWN or UP) to the console
  * 
+ * Logs in the pretty format, or as a CSV / JSON line if LUMBERJACK_CSV /
+ * LUMBERJACK_JSON is defined.
+ * 
  * @param keypress_data tracking data for the keypress to be logged
  * @param keycode keycode for the keypress to be logged
  * @param delta milliseconds since the preceeding key event
- * @param pressed true for DOWN, false for UP
+ * @param cross_half true if the preceeding key event was on the other half of
+ *                   a split keyboard (delta is flagged with a '~')
+ * @param record record for the key event to be logged
  * 
  */
 void lumberjack_log_input(const keypress_t* keypress_data,
-                          uint16_t keycode, uint16_t delta,
-                          bool pressed);
+                          uint16_t keycode, uint16_t delta, bool cross_half,
+                          const keyrecord_t* record);
 
 
 /**
@@ -31,3 +48,23 @@ void lumberjack_log_input(const keypress_t* keypress_data,
  */
 void lumberjack_log_interpreted_event(const char *prefix, uint16_t keycode,
                                       keyrecord_t *record);
+
+
+/**
+ * @brief Log a one-line summary of a burst of typing to the console
+ * 
+ * @param burst aggregates for the burst to be logged
+ * @param mean_delta mean delta between the burst's key events
+ * 
+ */
+void lumberjack_log_burst(const lumberjack_burst_t* burst,
+                          uint16_t mean_delta);
+
+
+/**
+ * @brief Log the split transport's estimated latency to the console
+ * 
+ * @param latency_x16 one-way latency, in 1/16ths of a millisecond
+ * 
+ */
+void lumberjack_log_split_latency(uint16_t latency_x16);
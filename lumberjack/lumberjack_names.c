@@ -0,0 +1,68 @@
+#include "lumberjack_names.h"
+#include "lumberjack_utils.h"
+
+// First byte value used for dictionary references
+#define DICT_REF 0x80
+
+
+// Returns the index of keycode in the table, or -1 if not present
+// (tables only hold the keycodes of a single keymap, so a linear scan of
+//  16-bit values is both small and quick)
+int16_t lumberjack_find_name(const lumberjack_names_t* names,
+                             uint16_t keycode) {
+    for (uint16_t i = 0; i < names->count; i++) {
+        if (LUMBERJACK_READ_WORD(&names->keycodes[i]) == keycode) {
+            return (int16_t)i;
+        }
+    }
+    return -1;
+}
+
+
+// Appends bytes from a (possibly PROGMEM) string to dest; returns the new
+// length of dest
+static uint8_t append_progmem(char* dest, uint8_t len, uint8_t dest_size,
+                              const char* src) {
+    char c;
+    while (len < dest_size - 1 && (c = LUMBERJACK_READ_BYTE(src++)) != '\0') {
+        dest[len++] = c;
+    }
+    dest[len] = '\0';
+    return len;
+}
+
+
+// Decompresses name at index onto the end of dest
+void lumberjack_append_name(char* dest, uint8_t dest_size,
+                            const lumberjack_names_t* names, int16_t index) {
+    if (!dest || dest_size == 0 || index < 0 || index >= names->count) return;
+
+    uint8_t len = lumberjack_str_len(dest, dest_size - 1);
+    const char* src = names->pool
+                      + LUMBERJACK_READ_WORD(&names->offsets[index]);
+
+    uint8_t c;
+    while (len < dest_size - 1 && (c = LUMBERJACK_READ_BYTE(src++)) != '\0') {
+        if (c >= DICT_REF) { // expand dictionary word
+            uint16_t offset
+                = LUMBERJACK_READ_WORD(&names->dict_offsets[c - DICT_REF]);
+            len = append_progmem(dest, len, dest_size, names->dict + offset);
+        }
+        else {
+            dest[len++] = (char)c;
+        }
+    }
+    dest[len] = '\0';
+}
+
+
+// Appends src to dest
+void lumberjack_append_string(char* dest, uint8_t dest_size,
+                              const char* src) {
+    if (!dest || !src || dest_size == 0) return;
+    uint8_t len = lumberjack_str_len(dest, dest_size - 1);
+    while (len < dest_size - 1 && *src != '\0') {
+        dest[len++] = *src++;
+    }
+    dest[len] = '\0';
+}
@@ -0,0 +1,86 @@
+/**
+ * @file lumberjack_names.h
+ * @brief Lookup & decompression for generated keycode name tables
+ *
+ * Keycode name tables are generated at build time by
+ * tools/gen_keycode_names.py, and contain names for only those keycodes
+ * found in the user's keymap.  Names are stored in a dictionary-compressed
+ * string pool: any byte from 0x80 upwards is a reference to a word in the
+ * dictionary (0x80 = first word, 0x81 = second word, and so on).
+ *
+ * Tables may be stored in PROGMEM; all reads go through
+ * LUMBERJACK_READ_BYTE() / LUMBERJACK_READ_WORD().
+ *
+ * @author dave-thompson
+ */
+
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __AVR__
+    #include <avr/pgmspace.h>
+    #define LUMBERJACK_READ_BYTE(p) pgm_read_byte(p)
+    #define LUMBERJACK_READ_WORD(p) pgm_read_word(p)
+#else
+    #define LUMBERJACK_READ_BYTE(p) (*(const uint8_t*)(p))
+    #define LUMBERJACK_READ_WORD(p) (*(const uint16_t*)(p))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * @brief A generated keycode name table
+ */
+typedef struct {
+    const uint16_t* keycodes;     // keycode for each name
+    const uint16_t* offsets;      // offset of each name in pool
+    uint16_t count;               // number of names
+    const char* pool;             // compressed, null-separated names
+    const char* dict;             // null-separated dictionary words
+    const uint16_t* dict_offsets; // offset of each word in dict
+} lumberjack_names_t;
+
+
+/**
+ * @brief Find a keycode in a name table
+ *
+ * @param names name table to search
+ * @param keycode keycode to find
+ *
+ * @return index of the keycode's name, or -1 if not found
+ */
+int16_t lumberjack_find_name(const lumberjack_names_t* names,
+                             uint16_t keycode);
+
+
+/**
+ * @brief Decompress a name from a name table, appending it to dest
+ *
+ * @param dest destination buffer, already null-terminated
+ * @param dest_size size of destination buffer including null terminator
+ * @param names name table
+ * @param index index of the name, as returned by lumberjack_find_name()
+ *
+ * @note name is truncated if dest is too small
+ */
+void lumberjack_append_name(char* dest, uint8_t dest_size,
+                            const lumberjack_names_t* names, int16_t index);
+
+
+/**
+ * @brief Append a plain string to dest, truncating if necessary
+ *
+ * @param dest destination buffer, already null-terminated
+ * @param dest_size size of destination buffer including null terminator
+ * @param src null-terminated string to append
+ */
+void lumberjack_append_string(char* dest, uint8_t dest_size, const char* src);
+
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,172 @@
+#include "quantum.h"
+#include "lumberjack_config.h"
+#include "lumberjack_tracking.h"
+#include "lumberjack_split.h"
+
+#if defined(SPLIT_KEYBOARD) && defined(LUMBERJACK_SPLIT_LATENCY)
+    #include "transactions.h"
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Halves
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// Split keyboards put the left half's rows first, then the right half's
+char lumberjack_half(keypos_t key) {
+    #ifdef SPLIT_KEYBOARD
+        return key.row < MATRIX_ROWS / 2 ? 'L' : 'R';
+    #else
+        return '-';
+    #endif
+}
+
+
+bool lumberjack_is_remote(keypos_t key) {
+    #ifdef SPLIT_KEYBOARD
+        return (key.row < MATRIX_ROWS / 2) != is_keyboard_left();
+    #else
+        return false;
+    #endif
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Latency
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// one-way latency estimate, in 1/128ths of a ms (reported in 1/16ths): the
+// extra bits keep small changes from being lost when averaging
+static uint32_t latency_x128 = 0;
+static bool have_estimate = false;
+
+// change in latency estimate (in 1/16ths of a ms) worth logging
+#define LATENCY_LOG_THRESHOLD 4
+
+uint16_t lumberjack_split_latency_x16(void) {
+    return have_estimate ? (uint16_t)(latency_x128 >> 3) : 0;
+}
+
+
+uint16_t lumberjack_split_correct_delta(uint16_t delta, bool was_remote,
+                                        bool is_remote) {
+    #ifdef LUMBERJACK_SPLIT_CORRECT
+        if (delta == UINT16_MAX || was_remote == is_remote) return delta;
+
+        uint16_t latency = (lumberjack_split_latency_x16() + 8) >> 4; // in ms
+        if (is_remote) { // arrived late: delta too long
+            return delta > latency ? delta - latency : 0;
+        }
+        if (delta < LUMBERJACK_MAX_DELTA - latency) { // previous arrived late
+            return delta + latency;
+        }
+    #endif
+    return delta;
+}
+
+
+#if defined(SPLIT_KEYBOARD) && defined(LUMBERJACK_SPLIT_LATENCY)
+
+    // Round trips take around a ms, so are timed with the DWT cycle counter
+    // where there is one (Cortex-M3 / M4 / M7 / M33).  Elsewhere, they're
+    // timed with the ms timer: each sample is then 0 or 1 ms, and only the
+    // average of many is meaningful.
+    #if (defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__) \
+            || defined(__ARM_ARCH_8M_MAIN__)) && defined(CPU_CLOCK)
+
+        #define DEMCR         (*(volatile uint32_t *)0xE000EDFC)
+        #define DEMCR_TRCENA  (1u << 24)
+        #define DWT_CTRL      (*(volatile uint32_t *)0xE0001000)
+        #define DWT_CYCCNT    (*(volatile uint32_t *)0xE0001004)
+        #define DWT_LAR       (*(volatile uint32_t *)0xE0001FB0)
+        #define DWT_CYCCNTENA 1u
+
+        #define TICKS_PER_MS (CPU_CLOCK / 1000)
+
+        static void start_fine_timer(void) {
+            DEMCR |= DEMCR_TRCENA;
+            DWT_LAR = 0xC5ACCE55; // unlock, where required (e.g. Cortex-M7)
+            DWT_CTRL |= DWT_CYCCNTENA;
+        }
+
+        static inline uint32_t read_fine_timer(void) {
+            return DWT_CYCCNT;
+        }
+
+    #else
+
+        #define TICKS_PER_MS 1
+
+        static void start_fine_timer(void) {}
+
+        static inline uint32_t read_fine_timer(void) {
+            return timer_read32();
+        }
+
+    #endif
+
+
+    // Secondary half: answer the master's sync request immediately
+    static void sync_handler(uint8_t in_len, const void* in_data,
+                             uint8_t out_len, void* out_data) {
+        if (out_len >= sizeof(uint8_t)) *(uint8_t*)out_data = 1;
+    }
+
+
+    void lumberjack_split_init(void) {
+        start_fine_timer();
+        transaction_register_rpc(LUMBERJACK_SYNC, sync_handler);
+    }
+
+
+    // Master: time a round trip to the secondary half, and fold half of it
+    // into the running (exponentially weighted) latency estimate
+    bool lumberjack_split_task(void) {
+        static uint32_t last_sample = 0;
+        static uint16_t last_logged_x16 = 0;
+
+        if (!is_keyboard_master() || lumberjack_num_tracked_keys() > 0
+                || timer_elapsed32(last_sample) < LUMBERJACK_SPLIT_SYNC_INTERVAL) {
+            return false;
+        }
+
+        uint8_t request = 0, response = 0;
+        uint32_t start = read_fine_timer();
+        bool ok = transaction_rpc_exec(LUMBERJACK_SYNC, sizeof(request),
+                                       &request, sizeof(response), &response);
+        uint32_t round_trip = read_fine_timer() - start;
+        last_sample = timer_read32();
+        if (!ok || round_trip / TICKS_PER_MS > UINT16_MAX / 64) return false;
+
+        // half the round trip, in 1/128 ms
+        uint32_t sample_x128 = (uint32_t)((uint64_t)round_trip * 64
+                                          / TICKS_PER_MS);
+        if (!have_estimate) {
+            latency_x128 = sample_x128;
+            have_estimate = true;
+        }
+        else { // new = old + (sample - old) / 8
+            latency_x128 = latency_x128 - latency_x128 / 8 + sample_x128 / 8;
+        }
+
+        uint16_t latency_x16 = lumberjack_split_latency_x16();
+        uint16_t change = latency_x16 > last_logged_x16
+                          ? latency_x16 - last_logged_x16
+                          : last_logged_x16 - latency_x16;
+        if (change < LATENCY_LOG_THRESHOLD) return false;
+        last_logged_x16 = latency_x16;
+        return true;
+    }
+
+#else
+
+    void lumberjack_split_init(void) {}
+
+    bool lumberjack_split_task(void) {
+        return false;
+    }
+
+#endif
@@ -0,0 +1,92 @@
+/**
+ * @file lumberjack_split.h
+ * @brief Attribution of key events to the halves of a split keyboard
+ *
+ * On split keyboards, key events from the secondary half reach the master
+ * through the split transport, so arrive later than events from the master
+ * half.  This skews deltas between keys on opposite halves (durations are
+ * unaffected, as a key's DOWN and UP come from the same half).
+ *
+ * Define LUMBERJACK_SPLIT_LATENCY (and add LUMBERJACK_SYNC to
+ * SPLIT_TRANSACTION_IDS_USER) to have the master periodically time a round
+ * trip to the secondary half and keep a running estimate of the transport's
+ * one-way latency.  Define LUMBERJACK_SPLIT_CORRECT to also subtract that
+ * latency from cross-half deltas.
+ *
+ * Round trips are timed with the DWT cycle counter on Cortex-M3 / M4 / M7 /
+ * M33 (where QMK defines CPU_CLOCK).  Elsewhere only the ms timer is
+ * available: each sample is then whole ms, and the estimate is only as good
+ * as the average of many samples.
+ *
+ * On non-split keyboards, all events are attributed to the master half.
+ *
+ * @author dave-thompson
+ */
+
+#pragma once
+
+#include "quantum.h"
+
+#ifndef LUMBERJACK_SPLIT_SYNC_INTERVAL
+    #define LUMBERJACK_SPLIT_SYNC_INTERVAL 1000 // ms between latency samples
+#endif
+
+
+/**
+ * @brief Which half of a split keyboard a key is on
+ *
+ * @param key key position
+ *
+ * @return 'L' or 'R', or '-' if the keyboard is not split
+ */
+char lumberjack_half(keypos_t key);
+
+
+/**
+ * @brief true if a key's events reach the master through the split transport
+ *
+ * @param key key position
+ */
+bool lumberjack_is_remote(keypos_t key);
+
+
+/**
+ * @brief Estimated one-way latency of the split transport
+ *
+ * @return latency in 1/16ths of a millisecond, or 0 if not yet measured
+ */
+uint16_t lumberjack_split_latency_x16(void);
+
+
+/**
+ * @brief Correct a delta for the split transport's latency
+ *
+ * Deltas between events on the same half need no correction.  A remote event
+ * following a local event arrived late, so its delta is too long; a local
+ * event following a remote event has a delta which is too short.
+ *
+ * @param delta measured delta (UINT16_MAX for no delta)
+ * @param was_remote true if the preceding event was remote
+ * @param is_remote true if this event is remote
+ *
+ * @return corrected delta, or delta unchanged if LUMBERJACK_SPLIT_CORRECT is
+ *         not defined
+ */
+uint16_t lumberjack_split_correct_delta(uint16_t delta, bool was_remote,
+                                        bool is_remote);
+
+
+/**
+ * @brief Register the latency sync handler (call from keyboard_post_init)
+ */
+void lumberjack_split_init(void);
+
+
+/**
+ * @brief Sample the split transport's latency (call from housekeeping)
+ *
+ * Samples are only taken on the master, while no keys are held.
+ *
+ * @return true if the latency estimate has changed enough to be worth logging
+ */
+bool lumberjack_split_task(void);
@@ -109,3 +109,9 @@ keypress_t lumberjack_track_key(uint16_t keycode, const keyrecord_t *record) {
         return track_released_key(keycode, record);
     }
 }
+
+
+// Returns the number of currently depressed (tracked) keys
+uint8_t lumberjack_num_tracked_keys(void) {
+    return num_depressed_keys;
+}
@@ -34,3 +34,12 @@ typedef struct {
  * 
  */
 keypress_t lumberjack_track_key(uint16_t keycode, const keyrecord_t *record);
+
+
+/**
+ * @brief Number of keys currently held down (and tracked)
+ * 
+ * @return number of tracked keys which have been pressed DOWN but not yet
+ *         released UP
+ */
+uint8_t lumberjack_num_tracked_keys(void);
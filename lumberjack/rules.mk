@@ -1,3 +1,6 @@
+# directory of this module (before any other makefile is included)
+LUMBERJACK_PATH := $(dir $(lastword $(MAKEFILE_LIST)))
+
 # module enabled by default, unless user explicitly disables it
 LUMBERJACK_ENABLE ?= yes
 
@@ -9,6 +12,27 @@ ifeq ($(strip $(LUMBERJACK_ENABLE)),yes)
 	SRC += lumberjack_config.c
 	SRC += lumberjack_tracking.c
 	SRC += lumberjack_logging.c
+	SRC += lumberjack_burst.c
+	SRC += lumberjack_filter.c
+	SRC += lumberjack_names.c
+	SRC += lumberjack_split.c
+
+	# optionally generate a compact keycode name table from the keymap
+	ifeq ($(strip $(LUMBERJACK_KEYCODE_NAMES)),yes)
+		LUMBERJACK_KEYMAP := $(firstword $(wildcard $(KEYMAP_PATH)/keymap.c \
+		                                            $(KEYMAP_PATH)/keymap.json))
+		LUMBERJACK_NAMES_DIR := $(INTERMEDIATE_OUTPUT)/lumberjack
+		LUMBERJACK_NAMES_ERROR := $(shell python3 \
+		    $(LUMBERJACK_PATH)tools/gen_keycode_names.py \
+		    $(LUMBERJACK_KEYMAP) \
+		    $(LUMBERJACK_NAMES_DIR)/lumberjack_keycode_names.h 2>&1)
+		ifneq ($(LUMBERJACK_NAMES_ERROR),)
+			$(error Lumberjack keycode names: $(LUMBERJACK_NAMES_ERROR))
+		endif
+		VPATH += $(LUMBERJACK_NAMES_DIR)
+		OPT_DEFS += -DLUMBERJACK_KEYCODE_NAMES
+		KEYCODE_STRING_ENABLE ?= no # names table replaces keycode string
+	endif
 
 	# enable required features
 	CONSOLE_ENABLE = yes # compulsory
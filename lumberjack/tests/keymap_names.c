@@ -0,0 +1,16 @@
+// Test input for tools/gen_keycode_names.py (test_gen_keycode_names.c)
+
+#define HOME_S LSFT_T(KC_S)
+#define HOME(k) LGUI_T(k)   // function-like: expanded
+#define NAV(layer) MO(layer)
+#define PAIR(a, b) KC_A     // wrong number of arguments below: skipped
+
+enum custom_keycodes {
+    MY_KEY = SAFE_RANGE,
+    OTHER_KEY,
+};
+
+const uint16_t keymaps[][1][6] = {
+    [0] = LAYOUT(HOME_S, HOME(KC_D), NAV(1), PAIR(KC_X), LT(1, HOME(KC_F)),
+                 MY_KEY)
+};
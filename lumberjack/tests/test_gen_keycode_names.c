@@ -0,0 +1,66 @@
+#include "unity/unity.h"
+#include "../lumberjack_names.h"
+
+// Just enough of QMK's keycodes for the generated table to compile
+#define PROGMEM
+#define KC_D 0x0007
+#define KC_F 0x0009
+#define KC_S 0x0016
+#define LSFT_T(kc) (0x2200 | (kc))
+#define MO(layer) (0x5220 | (layer))
+#define SAFE_RANGE 0x7E40
+
+// Generated from keymap_names.c by tools/gen_keycode_names.py
+#include "keymap_names.h"
+
+static const lumberjack_names_t names = {
+    lumberjack_name_keycodes, lumberjack_name_offsets, LUMBERJACK_NAMES_COUNT,
+    lumberjack_name_pool, lumberjack_name_dict, lumberjack_name_dict_offsets
+};
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+static void assert_name(const char* expected, uint16_t keycode) {
+    char buffer[31+1] = "";
+    int16_t index = lumberjack_find_name(&names, keycode);
+
+    TEST_ASSERT_NOT_EQUAL(-1, index);
+    lumberjack_append_name(buffer, 31+1, &names, index);
+    TEST_ASSERT_EQUAL_STRING(expected, buffer);
+}
+
+void test_object_like_defines_are_expanded(void) {
+    assert_name("HOME_S", LSFT_T(KC_S));
+}
+
+void test_function_like_mod_taps_name_their_tap_keycode(void) {
+    assert_name("KC_D", KC_D);
+    assert_name("KC_F", KC_F); // inside LT(1, HOME(KC_F))
+}
+
+void test_function_like_defines_are_expanded(void) {
+    assert_name("MO(1)", MO(1));
+}
+
+void test_custom_keycodes_are_named(void) {
+    assert_name("MY_KEY", SAFE_RANGE);
+    assert_name("OTHER_KEY", SAFE_RANGE + 1);
+}
+
+void test_unexpandable_macros_are_skipped(void) {
+    TEST_ASSERT_EQUAL(6, LUMBERJACK_NAMES_COUNT);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_object_like_defines_are_expanded);
+    RUN_TEST(test_function_like_mod_taps_name_their_tap_keycode);
+    RUN_TEST(test_function_like_defines_are_expanded);
+    RUN_TEST(test_custom_keycodes_are_named);
+    RUN_TEST(test_unexpandable_macros_are_skipped);
+
+    return UNITY_END();
+}
@@ -0,0 +1,83 @@
+#include "unity/unity.h"
+#include "../lumberjack_burst.h"
+
+void setUp(void) {
+    lumberjack_burst_reset();
+}
+
+void tearDown(void) {}
+
+void test_new_burst_is_empty(void) {
+    const lumberjack_burst_t* burst = lumberjack_burst();
+    TEST_ASSERT_EQUAL(0, burst->events);
+    TEST_ASSERT_EQUAL(0, burst->presses);
+    TEST_ASSERT_EQUAL(0, burst->duration);
+    TEST_ASSERT_EQUAL(0, lumberjack_burst_mean_delta());
+}
+
+void test_first_delta_is_ignored(void) {
+    lumberjack_burst_add_event(5000, true, true, 1);
+
+    const lumberjack_burst_t* burst = lumberjack_burst();
+    TEST_ASSERT_EQUAL(1, burst->events);
+    TEST_ASSERT_EQUAL(0, burst->duration);
+    TEST_ASSERT_EQUAL(0, burst->max_delta);
+}
+
+void test_deltas_aggregate_correctly(void) {
+    lumberjack_burst_add_event(UINT16_MAX, true, true, 1);
+    lumberjack_burst_add_event(100, false, true, 0);
+    lumberjack_burst_add_event(50, true, true, 1);
+    lumberjack_burst_add_event(150, false, true, 0);
+
+    const lumberjack_burst_t* burst = lumberjack_burst();
+    TEST_ASSERT_EQUAL(4, burst->events);
+    TEST_ASSERT_EQUAL(2, burst->presses);
+    TEST_ASSERT_EQUAL(300, burst->duration);
+    TEST_ASSERT_EQUAL(150, burst->max_delta);
+    TEST_ASSERT_EQUAL(100, lumberjack_burst_mean_delta());
+}
+
+void test_untracked_and_simultaneous_keys_are_counted(void) {
+    lumberjack_burst_add_event(UINT16_MAX, true, true, 1);
+    lumberjack_burst_add_event(20, true, true, 2);
+    lumberjack_burst_add_event(20, true, false, 2);
+    lumberjack_burst_add_event(20, false, true, 1);
+
+    const lumberjack_burst_t* burst = lumberjack_burst();
+    TEST_ASSERT_EQUAL(1, burst->untracked);
+    TEST_ASSERT_EQUAL(2, burst->max_simultaneous);
+}
+
+void test_mod_tap_holds_are_counted(void) {
+    lumberjack_burst_add_mod_tap_hold();
+    lumberjack_burst_add_mod_tap_hold();
+    TEST_ASSERT_EQUAL(2, lumberjack_burst()->mod_tap_holds);
+}
+
+void test_reset_clears_burst(void) {
+    lumberjack_burst_add_event(UINT16_MAX, true, false, 3);
+    lumberjack_burst_add_event(100, false, true, 2);
+    lumberjack_burst_add_mod_tap_hold();
+    lumberjack_burst_reset();
+
+    const lumberjack_burst_t* burst = lumberjack_burst();
+    TEST_ASSERT_EQUAL(0, burst->events);
+    TEST_ASSERT_EQUAL(0, burst->untracked);
+    TEST_ASSERT_EQUAL(0, burst->mod_tap_holds);
+    TEST_ASSERT_EQUAL(0, burst->max_simultaneous);
+    TEST_ASSERT_EQUAL(0, burst->duration);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_new_burst_is_empty);
+    RUN_TEST(test_first_delta_is_ignored);
+    RUN_TEST(test_deltas_aggregate_correctly);
+    RUN_TEST(test_untracked_and_simultaneous_keys_are_counted);
+    RUN_TEST(test_mod_tap_holds_are_counted);
+    RUN_TEST(test_reset_clears_burst);
+
+    return UNITY_END();
+}
@@ -0,0 +1,69 @@
+#include "unity/unity.h"
+#include "../lumberjack_names.h"
+
+// Table in the format written by tools/gen_keycode_names.py
+// (dictionary: 0x80 = "KC_", 0x81 = "SPC")
+static const uint16_t keycodes[] = { 0x0004, 0x002C, 0x7E00 };
+static const uint16_t offsets[] = { 0, 3, 6 };
+static const char pool[] = "\200A\0\200\201\0MY_KEY";
+static const uint16_t dict_offsets[] = { 0, 4 };
+static const char dict[] = "KC_\0SPC";
+
+static const lumberjack_names_t names = {
+    keycodes, offsets, 3, pool, dict, dict_offsets
+};
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_find_name_returns_index(void) {
+    TEST_ASSERT_EQUAL(0, lumberjack_find_name(&names, 0x0004));
+    TEST_ASSERT_EQUAL(2, lumberjack_find_name(&names, 0x7E00));
+}
+
+void test_find_name_returns_minus_one_when_missing(void) {
+    TEST_ASSERT_EQUAL(-1, lumberjack_find_name(&names, 0x0005));
+}
+
+void test_append_name_expands_dictionary_words(void) {
+    char buffer[15+1] = "";
+
+    lumberjack_append_name(buffer, 15+1, &names, 1);
+    TEST_ASSERT_EQUAL_STRING("KC_SPC", buffer);
+}
+
+void test_append_name_appends_to_existing_string(void) {
+    char buffer[15+1] = "LT(1,";
+
+    lumberjack_append_name(buffer, 15+1, &names, 0);
+    lumberjack_append_string(buffer, 15+1, ")");
+    TEST_ASSERT_EQUAL_STRING("LT(1,KC_A)", buffer);
+}
+
+void test_append_name_handles_plain_names(void) {
+    char buffer[15+1] = "";
+
+    lumberjack_append_name(buffer, 15+1, &names, 2);
+    TEST_ASSERT_EQUAL_STRING("MY_KEY", buffer);
+}
+
+void test_append_name_truncates_long_names(void) {
+    char buffer[4+1] = "";
+
+    lumberjack_append_name(buffer, 4+1, &names, 1);
+    TEST_ASSERT_EQUAL_STRING("KC_S", buffer);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_find_name_returns_index);
+    RUN_TEST(test_find_name_returns_minus_one_when_missing);
+    RUN_TEST(test_append_name_expands_dictionary_words);
+    RUN_TEST(test_append_name_appends_to_existing_string);
+    RUN_TEST(test_append_name_handles_plain_names);
+    RUN_TEST(test_append_name_truncates_long_names);
+
+    return UNITY_END();
+}
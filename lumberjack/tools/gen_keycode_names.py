@@ -0,0 +1,383 @@
+#!/usr/bin/env python3
+"""
+gen_keycode_names.py - Lumberjack keycode name table generator
+
+Reads a QMK keymap (keymap.c or keymap.json) and writes a C header with a
+compact table of human-readable names for just the keycodes used in that
+keymap.  Names are stored in a dictionary-compressed string pool: common
+substrings (e.g. "KC_", "LSFT") are stored once and referenced by a single
+byte (0x80 + word index).
+
+Mod-taps and layer-taps are not stored whole.  Instead, their tap keycodes
+are added to the table, and Lumberjack composes the full name at runtime,
+e.g. LSFT_T(KC_S) -> "LSFT_T(" + "KC_S" + ")".
+
+The keycode values themselves are left to the C compiler: the table is
+written using the keymap's own keycode expressions.  Names which are local to
+keymap.c (#defines and enums, such as custom keycodes or layer names) are
+expanded to their definitions, and quoted #includes are copied across, so
+that the table compiles outside of keymap.c.  Keys written with keymap-local
+function-like macros, e.g. HOME(KC_A) for #define HOME(k) LGUI_T(k), are
+expanded too (and skipped if they can't be).
+
+Usage:
+    gen_keycode_names.py <keymap.c | keymap.json> <output.h>
+
+The output file is only rewritten if its content changes, so the build
+does not recompile Lumberjack unnecessarily.
+
+Author: dave-thompson
+"""
+
+import json
+import os
+import re
+import sys
+
+MAX_DICT_WORDS = 128   # dictionary references are 0x80 to 0xFF
+MIN_WORD_LEN = 2
+MAX_WORD_LEN = 8
+
+# Keycodes never worth naming (blank or transparent keys)
+SKIPPED = {"_______", "XXXXXXX", "KC_NO", "KC_TRNS", "KC_TRANSPARENT",
+           "NO", "TRNS"}
+
+IDENTIFIER = re.compile(r"^[A-Za-z_][A-Za-z0-9_]*$")
+MOD_TAP_MACRO = re.compile(r"^([A-Z]+)_T\((.*)\)$")   # e.g. LSFT_T(KC_S)
+MT_MACRO = re.compile(r"^MT\(([^,]+),(.*)\)$")       # e.g. MT(MOD_LSFT, KC_S)
+LT_MACRO = re.compile(r"^LT\(([^,]+),(.*)\)$")       # e.g. LT(1, KC_SPC)
+
+
+###############################################################################
+#
+# Reading Keymaps
+#
+###############################################################################
+
+def strip_c_comments(text):
+    text = re.sub(r"/\*.*?\*/", " ", text, flags=re.S)
+    return re.sub(r"//[^\n]*", " ", text)
+
+
+def split_top_level(args):
+    """Split a macro argument list on commas outside of parentheses."""
+    parts, depth, current = [], 0, []
+    for char in args:
+        if char == "(":
+            depth += 1
+        elif char == ")":
+            depth -= 1
+        if char == "," and depth == 0:
+            parts.append("".join(current))
+            current = []
+        else:
+            current.append(char)
+    parts.append("".join(current))
+    return parts
+
+
+def layout_arguments(text, start):
+    """Return the text between the parenthesis at start and its partner."""
+    depth = 0
+    for i in range(start, len(text)):
+        if text[i] == "(":
+            depth += 1
+        elif text[i] == ")":
+            depth -= 1
+            if depth == 0:
+                return text[start + 1:i]
+    return ""
+
+
+class Keymap:
+    """Keycode tokens from a keymap, plus any keymap-local definitions."""
+
+    def __init__(self):
+        self.tokens = []     # keycode expressions, in keymap order
+        self.local = {}      # keymap-local name -> C expression
+        self.functions = {}  # keymap-local macro name -> (params, body)
+        self.includes = []   # quoted #includes, e.g. "keycodes.h"
+
+    def expand(self, expression, depth=0):
+        """Replace keymap-local names in expression with their definitions."""
+        if depth > 8:
+            return expression
+        def substitute(match):
+            name = match.group(0)
+            if name in self.local:
+                return "(" + self.expand(self.local[name], depth + 1) + ")"
+            return name
+        return re.sub(r"\b[A-Za-z_]\w*\b", substitute, expression)
+
+    def expand_call(self, token, depth=0):
+        """Expand a call to a keymap-local function-like macro, e.g.
+        HOME(KC_A) -> LGUI_T(KC_A), or return token unchanged."""
+        match = re.match(r"^([A-Za-z_]\w*)\(", token)
+        if (not match or match.group(1) not in self.functions or depth > 8
+                or len(layout_arguments(token, match.end() - 1))
+                   != len(token) - match.end() - 1):
+            return token
+        params, body = self.functions[match.group(1)]
+        args = split_top_level(token[match.end():-1])
+        if len(args) != len(params) and not (params == [] and args == [""]):
+            return token
+        values = dict(zip(params, args))
+        body = re.sub(r"\b[A-Za-z_]\w*\b",
+                      lambda m: values.get(m.group(0), m.group(0)), body)
+        return self.expand_call(re.sub(r"\s+", "", body), depth + 1)
+
+    def is_local_call(self, token):
+        """Is token still a call to a keymap-local function-like macro?"""
+        match = re.match(r"^([A-Za-z_]\w*)\(", token)
+        return bool(match) and match.group(1) in self.functions
+
+
+def read_enums(text, keymap):
+    """Record each enum entry as a C expression, e.g. SAFE_RANGE + 1."""
+    for match in re.finditer(r"\benum\s+\w*\s*\{(.*?)\}", text, flags=re.S):
+        base, count = "0", 0
+        for entry in split_top_level(match.group(1)):
+            name, _, value = entry.partition("=")
+            name = name.strip()
+            if not IDENTIFIER.match(name):
+                continue
+            if value.strip():
+                base, count = value.strip(), 0
+            keymap.local[name] = base if count == 0 else "%s + %u" % (base,
+                                                                      count)
+            count += 1
+
+
+def keymap_c(text):
+    keymap = Keymap()
+    keymap.includes = re.findall(r'^\s*#\s*include\s+("[^"]+")', text,
+                                 flags=re.M)
+    text = strip_c_comments(text)
+
+    # object-like #defines, e.g. #define HOME_A LGUI_T(KC_A)
+    for match in re.finditer(r"^\s*#\s*define\s+([A-Za-z_]\w*)[ \t]+(.+)$",
+                             text, flags=re.M):
+        keymap.local[match.group(1)] = match.group(2).strip()
+    # function-like #defines, e.g. #define HOME(k) LGUI_T(k)
+    for match in re.finditer(
+            r"^\s*#\s*define\s+([A-Za-z_]\w*)\(([^)]*)\)[ \t]*(.*)$",
+            text, flags=re.M):
+        params = [p.strip() for p in match.group(2).split(",") if p.strip()]
+        keymap.functions[match.group(1)] = (params, match.group(3).strip())
+    read_enums(text, keymap)
+
+    for match in re.finditer(r"\bLAYOUT\w*\s*\(", text):
+        args = layout_arguments(text, match.end() - 1)
+        keymap.tokens.extend(split_top_level(args))
+
+    # custom keycodes, e.g. enum custom_keycodes { MY_KEY = SAFE_RANGE, ... }
+    for match in re.finditer(r"\benum\s+\w*\s*\{(.*?)\}", text, flags=re.S):
+        body = match.group(1)
+        if "SAFE_RANGE" not in body and "QK_USER" not in body:
+            continue
+        for entry in split_top_level(body):
+            name = entry.split("=")[0].strip()
+            if IDENTIFIER.match(name):
+                keymap.tokens.append(name)
+    return keymap
+
+
+def keymap_json(text):
+    keymap = Keymap()
+    layers = json.loads(text).get("layers", [])
+    keymap.tokens = [key for layer in layers for key in layer]
+    return keymap
+
+
+def read_keymap(path):
+    with open(path, encoding="utf-8") as f:
+        text = f.read()
+    if path.endswith(".json"):
+        return keymap_json(text)
+    return keymap_c(text)
+
+
+###############################################################################
+#
+# Choosing Names
+#
+###############################################################################
+
+def collect_names(keymap):
+    """(name, expression) pairs to be tabled, in first-seen order."""
+    names = []
+
+    def add(token):
+        token = keymap.expand_call(re.sub(r"\s+", "", token))
+        if keymap.is_local_call(token):
+            return   # couldn't be expanded, so won't compile outside keymap.c
+        if not token or token in SKIPPED or token in (n for n, _ in names):
+            return
+        # mod-taps & layer-taps are composed at runtime from their tap keycode
+        for macro in (MOD_TAP_MACRO, MT_MACRO, LT_MACRO):
+            match = macro.match(token)
+            if match:
+                add(match.group(2))
+                return
+        # anything else must be a plain (or function-like) keycode expression
+        if IDENTIFIER.match(token) or re.match(r"^[A-Za-z_]\w*\(.*\)$", token):
+            names.append((token, keymap.expand(token)))
+
+    for token in keymap.tokens:
+        add(token)
+    return names
+
+
+###############################################################################
+#
+# Dictionary Compression
+#
+###############################################################################
+
+def encode(name, words):
+    """Greedily replace dictionary words in name with reference bytes."""
+    out, i = [], 0
+    while i < len(name):
+        best = None
+        for index, word in enumerate(words):
+            if name.startswith(word, i) and (best is None
+                                             or len(word) > len(words[best])):
+                best = index
+        if best is None:
+            out.append(ord(name[i]))
+            i += 1
+        else:
+            out.append(0x80 + best)
+            i += len(words[best])
+    return out
+
+
+def pool_size(names, words):
+    return (sum(len(encode(n, words)) + 1 for n in names)
+            + sum(len(w) + 1 for w in words))
+
+
+def build_dictionary(names):
+    """Pick the substrings which save the most bytes, one at a time."""
+    words = []
+    while len(words) < MAX_DICT_WORDS:
+        current = pool_size(names, words)
+        candidates = {}
+        for name in names:
+            for length in range(MIN_WORD_LEN, MAX_WORD_LEN + 1):
+                for i in range(len(name) - length + 1):
+                    word = name[i:i + length]
+                    candidates[word] = candidates.get(word, 0) + 1
+        # only substrings that occur more than once can save space
+        shortlist = sorted((w for w, n in candidates.items()
+                            if n > 1 and w not in words),
+                           key=lambda w: -(candidates[w] - 1) * (len(w) - 1))
+        best, best_size = None, current
+        for word in shortlist[:40]:
+            size = pool_size(names, words + [word])
+            if size < best_size:
+                best, best_size = word, size
+        if best is None:
+            break
+        words.append(best)
+    return words
+
+
+###############################################################################
+#
+# Writing the Header
+#
+###############################################################################
+
+def c_string(data):
+    """Render bytes as a C string literal, escaping everything non-printable."""
+    out = []
+    for byte in data:
+        char = chr(byte)
+        if 0x20 <= byte < 0x7F and char not in "\"\\?":
+            out.append(char)
+        else:
+            out.append("\\%03o" % byte)
+    return '"' + "".join(out) + '"'
+
+
+def render(keymap, entries, words, source):
+    names = [name for name, _ in entries]
+    encoded = [encode(n, words) for n in names]
+
+    pool, offsets = [], []
+    for data in encoded:
+        offsets.append(len(pool))
+        pool.extend(data + [0])
+
+    dict_pool, dict_offsets = [], []
+    for word in words:
+        dict_offsets.append(len(dict_pool))
+        dict_pool.extend([ord(c) for c in word] + [0])
+
+    lines = [
+        "// Generated by lumberjack/tools/gen_keycode_names.py from",
+        "// %s - do not edit" % os.path.basename(source),
+        "//",
+        "// %u names in %u bytes (%u bytes uncompressed)" % (
+            len(names), len(pool) + len(dict_pool),
+            sum(len(n) + 1 for n in names)),
+        "",
+        "#pragma once",
+        "",
+    ]
+    lines += ["#include %s" % include for include in keymap.includes]
+    if keymap.includes:
+        lines.append("")
+    lines += [
+        "#define LUMBERJACK_NAMES_COUNT %u" % len(names),
+        "",
+        "static const uint16_t lumberjack_name_keycodes[] PROGMEM = {",
+    ]
+    lines += [("    %s," % expr) if expr == name
+              else ("    %s, // %s" % (expr, name))
+              for name, expr in entries] or ["    KC_NO,"]
+    lines += ["};", "",
+              "static const uint16_t lumberjack_name_offsets[] PROGMEM = {"]
+    lines += ["    %u," % o for o in offsets] or ["    0,"]
+    lines += ["};", "", "static const char lumberjack_name_pool[] PROGMEM ="]
+    for i in range(0, len(pool), 16):
+        lines.append("    " + c_string(pool[i:i + 16]))
+    if not pool:
+        lines.append('    ""')
+    lines[-1] += ";"
+    lines += ["",
+              "static const uint16_t lumberjack_name_dict_offsets[] PROGMEM = {"]
+    lines += ["    %u," % o for o in dict_offsets] or ["    0,"]
+    lines += ["};", "", "static const char lumberjack_name_dict[] PROGMEM ="]
+    for i in range(0, len(dict_pool), 16):
+        lines.append("    " + c_string(dict_pool[i:i + 16]))
+    if not dict_pool:
+        lines.append('    ""')
+    lines[-1] += ";"
+    return "\n".join(lines) + "\n"
+
+
+def main(argv):
+    if len(argv) != 3:
+        sys.stderr.write(__doc__)
+        return 1
+    source, output = argv[1], argv[2]
+
+    keymap = read_keymap(source)
+    entries = collect_names(keymap)
+    words = build_dictionary([name for name, _ in entries])
+    content = render(keymap, entries, words, source)
+
+    os.makedirs(os.path.dirname(os.path.abspath(output)), exist_ok=True)
+    if os.path.exists(output):
+        with open(output, encoding="utf-8") as f:
+            if f.read() == content:
+                return 0
+    with open(output, "w", encoding="utf-8") as f:
+        f.write(content)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))